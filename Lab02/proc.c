@@ -548,6 +548,7 @@ int list_all_processes(void)
 {
   struct proc *p;
   cprintf("Print Info\n");
+  acquire(&ptable.lock);
   for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
   {
     if (p->state == RUNNING)
@@ -555,6 +556,7 @@ int list_all_processes(void)
       cprintf("Name: %s-PID: %d-number of system calls %d \n", p->name, p->pid, p->system_call_count);
     }
   }
+  release(&ptable.lock);
   return 0;
 }
 
@@ -628,9 +630,13 @@ char *syscall_names[27] = {"", "fork", "exit", "wait", "pipe", "read", "kill", "
 
 int get_most_invoked_syscall(int pid)
 {
-  struct proc *p = find_process_by_pid(pid);
+  // Scan the history under ptable.lock so that the process
+  // cannot be reaped and reused while we look at it.
+  acquire(&ptable.lock);
+  struct proc *p = findproc(pid);
   if (p == NULL)
   {
+    release(&ptable.lock);
     cprintf("The process does not exists in ptable!\n");
     return -1;
   }
@@ -646,6 +652,7 @@ int get_most_invoked_syscall(int pid)
       max_index = i;
     }
   }
+  release(&ptable.lock);
   if (empty)
   {
     cprintf("There is no system call in this process\n");
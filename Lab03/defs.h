@@ -7,6 +7,7 @@ struct proc;
 struct rtcdate;
 struct spinlock;
 struct sleeplock;
+struct reentrantlock;
 struct stat;
 struct superblock;
 
@@ -121,6 +122,9 @@ int             wait(void);
 void            wakeup(void*);
 void            yield(void);
 void            wrr_yeild(void);
+void            pilend(struct proc*, int*);
+void            pireturn(int*);
+void            piwaited(int, uint);
 
 // swtch.S
 void            swtch(struct context**, struct context*);
@@ -133,6 +137,10 @@ void            initlock(struct spinlock*, char*);
 void            release(struct spinlock*);
 void            pushcli(void);
 void            popcli(void);
+void            initreentrantlocks(void);
+void            acquirereentrantlock(struct reentrantlock*);
+int             releasereentrantlock(struct reentrantlock*);
+void            exitreentrantlocks(struct proc*);
 
 // sleeplock.c
 void            acquiresleep(struct sleeplock*);
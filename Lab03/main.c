@@ -28,6 +28,7 @@ main(void)
   uartinit();      // serial port
   pinit();         // process table
   tvinit();        // trap vectors
+  initreentrantlocks(); // locks for acquire_reentrant_lock
   binit();         // buffer cache
   fileinit();      // file table
   ideinit();       // disk 
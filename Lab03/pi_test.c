@@ -0,0 +1,59 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Priority inversion: a low-level (FCFS) process holds lock 0
+// while CPU-bound SJF processes keep it off the CPU and a
+// high-level (RR) process waits for the lock.  With priority
+// inheritance the holder runs at the waiter's level, so the
+// wait stays short.  Prints how long the waiter waited and the
+// kernel's inheritance counters.
+
+#define LOCK 0
+#define NUM_HOGS 3
+
+void spin(int n) {
+    volatile int i;
+    for (i = 0; i < n; i++)
+        ;
+}
+
+int main() {
+    int i, start;
+
+    if (fork() == 0) {
+        // Low: holds the lock across a long critical section.
+        change_queue(getpid(), 3);
+        acquire_reentrant_lock(LOCK);
+        sleep(5);
+        spin(100000000);
+        release_reentrant_lock(LOCK);
+        exit();
+    }
+    sleep(2);
+
+    for (i = 0; i < NUM_HOGS; i++) {
+        if (fork() == 0) {
+            // Medium: runnable the whole time, never takes the lock.
+            change_queue(getpid(), 2);
+            set_process_parameter(getpid(), 100, 1);
+            spin(400000000);
+            exit();
+        }
+    }
+
+    if (fork() == 0) {
+        // High: needs the lock.
+        change_queue(getpid(), 1);
+        start = uptime();
+        acquire_reentrant_lock(LOCK);
+        printf(1, "high-priority waiter got the lock after %d ticks\n", uptime() - start);
+        release_reentrant_lock(LOCK);
+        exit();
+    }
+
+    for (i = 0; i < NUM_HOGS + 2; i++)
+        wait();
+    print_pi_info();
+    exit();
+}
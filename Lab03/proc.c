@@ -92,6 +92,7 @@ found:
   p->pid = nextpid++;
   p->tick_count = 0;
   p->consecutive_run = 0;
+  p->pi_nlent = 0;
 
   if (p->pid == 1 || p->pid == 2) // || p->parent->pid == 2
   {
@@ -274,6 +275,8 @@ void exit(void)
   end_op();
   curproc->cwd = 0;
 
+  exitreentrantlocks(curproc);
+
   acquire(&ptable.lock);
 
   // Parent might be sleeping in wait().
@@ -878,8 +881,20 @@ int change_queue(int pid, int new_queue)
     {
       // cprintf("pre: %d",p->priority_level);
 
-      old_queue = p->priority_level;
-      p->priority_level = new_queue;
+      if (p->pi_nlent > 0)
+      {
+        // Boosted: change the level it returns to, and
+        // keep the lent level if that is higher.
+        old_queue = p->pi_base;
+        p->pi_base = new_queue;
+        if (new_queue < p->priority_level)
+          p->priority_level = new_queue;
+      }
+      else
+      {
+        old_queue = p->priority_level;
+        p->priority_level = new_queue;
+      }
       p->arrival_time = ticks;
       // cprintf("post: %d",p->priority_level);
 
@@ -951,6 +966,7 @@ void print_process_info(void)
   cprintf("--------------------------------------------------------------------------------------------------------------\n");
 
   struct proc *p;
+  acquire(&ptable.lock);
   for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
   {
     if (p->state == UNUSED)
@@ -991,4 +1007,109 @@ void print_process_info(void)
 
     cprintf("\n");
   }
+  release(&ptable.lock);
+}
+
+// Priority inheritance.
+//
+// A process about to wait for a lock held by a process of a
+// lower level (a larger priority_level) lends its own level to
+// the holder.  The holder keeps the best level lent to it until
+// it has released every lock whose waiters lent it priority,
+// then returns to pi_base.  Each lock records in *lent whether
+// it has been counted in its holder's pi_nlent.
+
+struct
+{
+  uint boosts;        // times a holder's level was raised
+  uint waits[4];      // lock waits, by waiter's level
+  uint waitticks[4];  // ticks spent waiting, by waiter's level
+  uint maxwait[4];    // longest wait, by waiter's level
+} pistats;
+
+// Lend the current process's level to holder.
+// Caller holds the lock's spinlock, which protects *lent.
+void pilend(struct proc *holder, int *lent)
+{
+  int level;
+
+  acquire(&ptable.lock);
+  level = myproc()->priority_level;
+  if (holder != 0 && level < holder->priority_level)
+  {
+    if (holder->pi_nlent == 0)
+      holder->pi_base = holder->priority_level;
+    if (!*lent)
+    {
+      *lent = 1;
+      holder->pi_nlent++;
+    }
+    holder->priority_level = level;
+    pistats.boosts++;
+  }
+  release(&ptable.lock);
+}
+
+// The current process released a lock; if its waiters lent it
+// priority and it holds no other such lock, drop back to pi_base.
+// Caller holds the lock's spinlock, which protects *lent.
+void pireturn(int *lent)
+{
+  struct proc *p = myproc();
+
+  if (!*lent)
+    return;
+  *lent = 0;
+  acquire(&ptable.lock);
+  if (--p->pi_nlent == 0)
+    p->priority_level = p->pi_base;
+  release(&ptable.lock);
+}
+
+// Record that a process of the given level waited
+// the given number of ticks for a lock.
+void piwaited(int level, uint t)
+{
+  if (level < 1 || level > 3)
+    return;
+  acquire(&ptable.lock);
+  pistats.waits[level]++;
+  pistats.waitticks[level] += t;
+  if (t > pistats.maxwait[level])
+    pistats.maxwait[level] = t;
+  release(&ptable.lock);
+}
+
+void print_pi_info(void)
+{
+  struct proc *p;
+  int level;
+
+  acquire(&ptable.lock);
+  cprintf("priority boosts: %d\n", pistats.boosts);
+  cprintf("level   waits   avg_wait   max_wait\n");
+  for (level = 1; level <= 3; level++)
+  {
+    cprintf("%d", level);
+    printspaces(8 - count_digits(level));
+    cprintf("%d", pistats.waits[level]);
+    printspaces(8 - count_digits(pistats.waits[level]));
+    if (pistats.waits[level] > 0)
+    {
+      cprintf("%d", pistats.waitticks[level] / pistats.waits[level]);
+      printspaces(11 - count_digits(pistats.waitticks[level] / pistats.waits[level]));
+    }
+    else
+    {
+      cprintf("-");
+      printspaces(10);
+    }
+    cprintf("%d\n", pistats.maxwait[level]);
+  }
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  {
+    if (p->state != UNUSED && p->pi_nlent > 0)
+      cprintf("pid %d boosted from %d to %d\n", p->pid, p->pi_base, p->priority_level);
+  }
+  release(&ptable.lock);
 }
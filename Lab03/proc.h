@@ -62,6 +62,8 @@ struct proc {
   int queue_waiting_time;     // record time we are waiting in a specific queue
   int consecutive_run;        // record number of ticks our process has runned consequtively
   int arrival_time;           // record time our process has entered 
+  int pi_base;                // own priority_level while boosted
+  int pi_nlent;               // held locks whose waiters lent priority
 };
 
 // Process memory is laid out contiguously, low addresses first:
@@ -16,19 +16,35 @@ initsleeplock(struct sleeplock *lk, char *name)
   initlock(&lk->lk, "sleep lock");
   lk->name = name;
   lk->locked = 0;
+  lk->owner = 0;
+  lk->lent = 0;
   lk->pid = 0;
 }
 
+// A waiter lends its priority_level to the holder
+// until the holder releases the lock.
 void
 acquiresleep(struct sleeplock *lk)
 {
+  struct proc *p = myproc();
+  int level, waited;
+  uint start;
+
   acquire(&lk->lk);
+  level = p->priority_level;
+  start = ticks;
+  waited = lk->locked;
   while (lk->locked) {
+    pilend(lk->owner, &lk->lent);
     sleep(lk, &lk->lk);
   }
   lk->locked = 1;
-  lk->pid = myproc()->pid;
+  lk->owner = p;
+  lk->pid = p->pid;
   release(&lk->lk);
+
+  if(waited)
+    piwaited(level, ticks - start);
 }
 
 void
@@ -36,7 +52,9 @@ releasesleep(struct sleeplock *lk)
 {
   acquire(&lk->lk);
   lk->locked = 0;
+  lk->owner = 0;
   lk->pid = 0;
+  pireturn(&lk->lent);
   wakeup(lk);
   release(&lk->lk);
 }
@@ -2,6 +2,8 @@
 struct sleeplock {
   uint locked;       // Is the lock held?
   struct spinlock lk; // spinlock protecting this sleep lock
+  struct proc *owner; // Process holding lock
+  int lent;           // Is a waiter's priority lent to owner?
   
   // For debugging:
   char *name;        // Name of lock.
@@ -124,3 +124,87 @@ popcli(void)
     sti();
 }
 
+// Reentrant locks, shared by all processes through the
+// acquire_reentrant_lock/release_reentrant_lock system calls.
+// A process that has to wait lends its priority_level to
+// the owner (see pilend in proc.c).
+
+struct reentrantlock rlocks[NRLOCK];
+
+void
+initreentrantlocks(void)
+{
+  int i;
+
+  for(i = 0; i < NRLOCK; i++){
+    initlock(&rlocks[i].lock, "reentrantlock");
+    rlocks[i].owner = 0;
+    rlocks[i].recursion = 0;
+    rlocks[i].lent = 0;
+  }
+}
+
+void
+acquirereentrantlock(struct reentrantlock *rlock)
+{
+  struct proc *p = myproc();
+  int level, waited;
+  uint start;
+
+  acquire(&rlock->lock);
+  if(rlock->owner == p){
+    rlock->recursion++;
+    release(&rlock->lock);
+    return;
+  }
+
+  level = p->priority_level;
+  start = ticks;
+  waited = rlock->owner != 0;
+  while(rlock->owner != 0){
+    pilend(rlock->owner, &rlock->lent);
+    sleep(rlock, &rlock->lock);
+  }
+  rlock->owner = p;
+  rlock->recursion = 1;
+  release(&rlock->lock);
+
+  if(waited)
+    piwaited(level, ticks - start);
+}
+
+// Returns -1 if the caller does not own rlock.
+int
+releasereentrantlock(struct reentrantlock *rlock)
+{
+  acquire(&rlock->lock);
+  if(rlock->owner != myproc()){
+    release(&rlock->lock);
+    return -1;
+  }
+  if(--rlock->recursion == 0){
+    rlock->owner = 0;
+    pireturn(&rlock->lent);
+    wakeup(rlock);
+  }
+  release(&rlock->lock);
+  return 0;
+}
+
+// Release every reentrant lock held by the exiting process p.
+void
+exitreentrantlocks(struct proc *p)
+{
+  struct reentrantlock *rlock;
+
+  for(rlock = rlocks; rlock < &rlocks[NRLOCK]; rlock++){
+    acquire(&rlock->lock);
+    if(rlock->owner == p){
+      rlock->owner = 0;
+      rlock->recursion = 0;
+      pireturn(&rlock->lent);
+      wakeup(rlock);
+    }
+    release(&rlock->lock);
+  }
+}
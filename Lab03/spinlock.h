@@ -9,3 +9,11 @@ struct spinlock {
                      // that locked the lock.
 };
 
+// Sleeping lock that its owner may acquire again.
+// lent is set while a waiter's priority is lent to owner.
+struct reentrantlock {
+  struct spinlock lock;  // protects the fields below
+  struct proc *owner;    // process holding the lock, or 0
+  int recursion;         // times owner has acquired it
+  int lent;
+};
@@ -106,6 +106,9 @@ extern int sys_uptime(void);
 extern int sys_change_scheduling_queue(void);
 extern int sys_set_process_parameter(void);
 extern int sys_print_process_info(void);
+extern int sys_acquire_reentrant_lock(void);
+extern int sys_release_reentrant_lock(void);
+extern int sys_print_pi_info(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -132,6 +135,9 @@ static int (*syscalls[])(void) = {
 [SYS_change_queue] sys_change_scheduling_queue,
 [SYS_set_process_parameter] sys_set_process_parameter,
 [SYS_print_process_info] sys_print_process_info,
+[SYS_acquire_reentrant_lock] sys_acquire_reentrant_lock,
+[SYS_release_reentrant_lock] sys_release_reentrant_lock,
+[SYS_print_pi_info] sys_print_pi_info,
 
 };
 
@@ -23,3 +23,6 @@
 #define SYS_set_process_parameter 22
 #define SYS_change_queue 24
 #define SYS_print_process_info 25
+#define SYS_acquire_reentrant_lock 26
+#define SYS_release_reentrant_lock 27
+#define SYS_print_pi_info 28
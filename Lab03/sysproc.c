@@ -6,6 +6,7 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "proc.h"
+#include "spinlock.h"
 
 int
 sys_fork(void)
@@ -122,4 +123,30 @@ int sys_print_process_info(void)
 {
   print_process_info();
   return 0;
-}
\ No newline at end of file
+}
+extern struct reentrantlock rlocks[];
+
+int sys_acquire_reentrant_lock(void)
+{
+  int id;
+  if (argint(0, &id) < 0 || id < 0 || id >= NRLOCK)
+    return -1;
+  acquirereentrantlock(&rlocks[id]);
+  return 0;
+}
+
+int sys_release_reentrant_lock(void)
+{
+  int id;
+  if (argint(0, &id) < 0 || id < 0 || id >= NRLOCK)
+    return -1;
+  return releasereentrantlock(&rlocks[id]);
+}
+
+extern void print_pi_info(void);
+
+int sys_print_pi_info(void)
+{
+  print_pi_info();
+  return 0;
+}
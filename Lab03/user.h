@@ -41,4 +41,7 @@ int change_queue(int pid, int new_queue);
 
 
 void set_process_parameter(int pid, int confidence, int time_burst);
-void print_process_info(void);
\ No newline at end of file
+void print_process_info(void);
+int acquire_reentrant_lock(int id);
+int release_reentrant_lock(int id);
+void print_pi_info(void);
\ No newline at end of file
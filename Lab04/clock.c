@@ -0,0 +1,77 @@
+// Monotonic clock.
+//
+// The timer interrupt on CPU 0 is the only writer: it advances
+// ticks and records the time-stamp counter at the tick under a
+// seqlock, so readers on any CPU never take a lock.  Between
+// ticks, clockus() interpolates with the TSC, whose rate is
+// measured against the timer over recent ticks.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "x86.h"
+#include "spinlock.h"
+
+struct
+{
+  struct seqlock seq;
+  uint64 tsctick; // TSC at the last tick
+  uint tscperus;  // TSC cycles per microsecond, 0 until calibrated
+} clock;
+
+void clockinit(void)
+{
+  initseqlock(&clock.seq);
+}
+
+// Called by the timer interrupt on CPU 0 only.
+void clocktick(void)
+{
+  uint64 now;
+  uint perus;
+
+  now = rdtsc();
+  seqwritebegin(&clock.seq);
+  if (clock.tsctick != 0 && now - clock.tsctick < 0xffffffff)
+  {
+    perus = (uint)(now - clock.tsctick) / TICKUS;
+    if (clock.tscperus == 0)
+      clock.tscperus = perus;
+    else // smooth out ticks that arrive late
+      clock.tscperus = (3 * clock.tscperus + perus) / 4;
+  }
+  clock.tsctick = now;
+  ticks++;
+  seqwriteend(&clock.seq);
+}
+
+// Microseconds since boot, to the resolution of the TSC.
+// The part below one tick is clamped so that the value
+// never runs past the next tick.  64 bits: a 32-bit count
+// of microseconds wraps after about 71 minutes.
+uint64 clockus(void)
+{
+  uint seq, t, perus, us;
+  uint64 base, d;
+
+  do
+  {
+    seq = seqreadbegin(&clock.seq);
+    t = ticks;
+    base = clock.tsctick;
+    perus = clock.tscperus;
+  } while (seqreadretry(&clock.seq, seq));
+
+  us = 0;
+  if (perus != 0)
+  {
+    d = rdtsc() - base;
+    if ((long long)d < 0) // TSCs of different CPUs may differ slightly
+      us = 0;
+    else if (d >= (uint64)perus * TICKUS)
+      us = TICKUS - 1;
+    else
+      us = (uint)d / perus;
+  }
+  return (uint64)t * TICKUS + us;
+}
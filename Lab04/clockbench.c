@@ -0,0 +1,48 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Several processes poll the clock at once; each checks that
+// uptime_us() never goes backwards and reports how many clock
+// reads it completed per tick.
+
+#define NPROCS 4
+#define CALLS 50000
+
+int main(int argc, char *argv[])
+{
+    int i, n, pid, start, elapsed, backwards;
+    uint64 prev, now, us0;
+
+    for (n = 0; n < NPROCS; n++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            printf(2, "clockbench: fork failed\n");
+            exit();
+        }
+        if (pid == 0)
+        {
+            backwards = 0;
+            start = uptime();
+            uptime_us(&us0);
+            prev = us0;
+            for (i = 0; i < CALLS; i++)
+            {
+                uptime_us(&now);
+                if (now < prev)
+                    backwards++;
+                prev = now;
+                uptime();
+            }
+            elapsed = uptime() - start;
+            printf(1, "proc %d: %d reads in %d ticks (%d us), %d went backwards\n",
+                   n, 2 * CALLS, elapsed, (uint)(prev - us0), backwards);
+            exit();
+        }
+    }
+    for (n = 0; n < NPROCS; n++)
+        wait();
+    exit();
+}
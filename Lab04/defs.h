@@ -1,15 +1,20 @@
 struct buf;
 struct context;
 struct file;
+struct files;
 struct inode;
 struct pipe;
 struct proc;
 struct rtcdate;
 struct spinlock;
 struct sleeplock;
+struct rwspinlock;
+struct seqlock;
+struct rwsleeplock;
 struct stat;
 struct superblock;
 struct reentrantlock;
+struct pcpucounter;
 
 // bio.c
 void binit(void);
@@ -17,6 +22,11 @@ struct buf *bread(uint, uint);
 void brelse(struct buf *);
 void bwrite(struct buf *);
 
+// clock.c
+void clockinit(void);
+void clocktick(void);
+uint64 clockus(void);
+
 // console.c
 void consoleinit(void);
 void cprintf(char *, ...);
@@ -31,10 +41,19 @@ struct file *filealloc(void);
 void fileclose(struct file *);
 struct file *filedup(struct file *);
 void fileinit(void);
+struct files *filesalloc(void);
+struct files *filescopy(struct files *);
+struct files *filesdup(struct files *);
+void filesput(struct files *);
 int fileread(struct file *, char *, int n);
 int filestat(struct file *, struct stat *);
 int filewrite(struct file *, char *, int n);
 
+// futex.c
+void futexinit(void);
+int futexwait(uint, int);
+int futexwake(uint, int);
+
 // fs.c
 void readsb(int dev, struct superblock *sb);
 int dirlink(struct inode *, char *, uint);
@@ -43,8 +62,10 @@ struct inode *ialloc(uint, short);
 struct inode *idup(struct inode *);
 void iinit(int dev);
 void ilock(struct inode *);
+void ilockshared(struct inode *);
 void iput(struct inode *);
 void iunlock(struct inode *);
+void iunlockshared(struct inode *);
 void iunlockput(struct inode *);
 void iupdate(struct inode *);
 int namecmp(const char *, const char *);
@@ -96,6 +117,11 @@ void mpinit(void);
 void picenable(int);
 void picinit(void);
 
+// percpu.c
+void pcpuadd(struct pcpucounter *, int);
+uint pcpureadcpu(struct pcpucounter *, int);
+uint pcpuread(struct pcpucounter *);
+
 // pipe.c
 int pipealloc(struct file **, struct file **);
 void pipeclose(struct pipe *, int);
@@ -120,6 +146,11 @@ void sleep(void *, struct spinlock *);
 void userinit(void);
 int wait(void);
 void wakeup(void *);
+int wakeupn(void *, int);
+int clone(void (*)(void *, void *), void *, void *, void *);
+int join(int, void **);
+void putvm(pde_t *);
+pde_t *execvm(pde_t *);
 void yield(void);
 
 // swtch.S
@@ -133,12 +164,28 @@ void initlock(struct spinlock *, char *);
 void release(struct spinlock *);
 void pushcli(void);
 void popcli(void);
+void initrwlock(struct rwspinlock *, char *);
+void acquireread(struct rwspinlock *);
+void releaseread(struct rwspinlock *);
+void acquirewrite(struct rwspinlock *);
+void releasewrite(struct rwspinlock *);
+void initseqlock(struct seqlock *);
+void seqwritebegin(struct seqlock *);
+void seqwriteend(struct seqlock *);
+uint seqreadbegin(struct seqlock *);
+int seqreadretry(struct seqlock *, uint);
 
 // sleeplock.c
 void acquiresleep(struct sleeplock *);
 void releasesleep(struct sleeplock *);
 int holdingsleep(struct sleeplock *);
 void initsleeplock(struct sleeplock *, char *);
+void initrwsleeplock(struct rwsleeplock *, char *);
+void acquiresleepread(struct rwsleeplock *);
+void releasesleepread(struct rwsleeplock *);
+void acquiresleepwrite(struct rwsleeplock *);
+void releasesleepwrite(struct rwsleeplock *);
+int holdingsleepwrite(struct rwsleeplock *);
 
 // string.c
 int memcmp(const void *, const void *, uint);
@@ -16,10 +16,99 @@ struct {
   struct file file[NFILE];
 } ftable;
 
+struct {
+  struct spinlock lock;  // protects each table's ref
+  struct files files[NPROC];
+} fdtable;
+
 void
 fileinit(void)
 {
+  struct files *fs;
+
   initlock(&ftable.lock, "ftable");
+  initlock(&fdtable.lock, "fdtable");
+  for(fs = fdtable.files; fs < fdtable.files + NPROC; fs++)
+    initlock(&fs->lock, "files");
+}
+
+// Allocate an empty file descriptor table.
+struct files*
+filesalloc(void)
+{
+  struct files *fs;
+
+  acquire(&fdtable.lock);
+  for(fs = fdtable.files; fs < fdtable.files + NPROC; fs++){
+    if(fs->ref == 0){
+      fs->ref = 1;
+      release(&fdtable.lock);
+      memset(fs->ofile, 0, sizeof(fs->ofile));
+      return fs;
+    }
+  }
+  release(&fdtable.lock);
+  return 0;
+}
+
+// Share table fs with one more process (a thread).
+struct files*
+filesdup(struct files *fs)
+{
+  acquire(&fdtable.lock);
+  if(fs->ref < 1)
+    panic("filesdup");
+  fs->ref++;
+  release(&fdtable.lock);
+  return fs;
+}
+
+// Make a copy of table fs for a new process (fork).
+// Returns 0 if there is no free table.
+struct files*
+filescopy(struct files *fs)
+{
+  struct files *nfs;
+  int fd;
+
+  if((nfs = filesalloc()) == 0)
+    return 0;
+  acquire(&fs->lock);
+  for(fd = 0; fd < NOFILE; fd++)
+    if(fs->ofile[fd])
+      nfs->ofile[fd] = filedup(fs->ofile[fd]);
+  release(&fs->lock);
+  return nfs;
+}
+
+// Drop a process's use of table fs.  The last process
+// using it closes its files.
+void
+filesput(struct files *fs)
+{
+  int fd;
+
+  acquire(&fdtable.lock);
+  if(fs->ref < 1)
+    panic("filesput");
+  if(fs->ref > 1){
+    fs->ref--;
+    release(&fdtable.lock);
+    return;
+  }
+  release(&fdtable.lock);
+
+  // Still holding the only reference, so no one else
+  // can reach the table while it is emptied.
+  for(fd = 0; fd < NOFILE; fd++){
+    if(fs->ofile[fd]){
+      fileclose(fs->ofile[fd]);
+      fs->ofile[fd] = 0;
+    }
+  }
+  acquire(&fdtable.lock);
+  fs->ref = 0;
+  release(&fdtable.lock);
 }
 
 // Allocate a file structure.
@@ -8,13 +8,20 @@ struct file {
   uint off;
 };
 
+// Open file descriptors.  The threads of a process share one
+// table (see clone); fork gives the child a copy.
+struct files {
+  struct spinlock lock;  // protects ofile; see argfd and sys_close
+  int ref;               // processes using the table
+  struct file *ofile[NOFILE];
+};
 
 // in-memory copy of an inode
 struct inode {
   uint dev;           // Device number
   uint inum;          // Inode number
   int ref;            // Reference count
-  struct sleeplock lock; // protects everything below here
+  struct rwsleeplock lock; // protects everything below here
   int valid;          // inode has been read from disk?
 
   short type;         // copy of disk inode
@@ -0,0 +1,86 @@
+// Futex-style wait/wake on a user address.
+//
+// A waiter sleeps only if the 32-bit word at the user address
+// still holds the value it expects; a waker changes the word in
+// user space first and then asks the kernel to wake sleepers.
+// Waiters are keyed on the kernel address of the word, so the key
+// is the same for every process that maps the same physical page.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "x86.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "spinlock.h"
+
+struct
+{
+  struct spinlock lock;
+} futextable;
+
+void futexinit(void)
+{
+  initlock(&futextable.lock, "futex");
+}
+
+// Translate user address uaddr of the current process into the
+// kernel address used as the sleep channel.
+// Returns 0 if uaddr is not a mapped, aligned user word.
+static int *
+futexkey(uint uaddr)
+{
+  char *page;
+
+  if (uaddr % sizeof(int) != 0)
+    return 0;
+  if ((page = uva2ka(myproc()->pgdir, (char *)uaddr)) == 0)
+    return 0;
+  return (int *)(page + (uaddr & (PGSIZE - 1)));
+}
+
+// Sleep until woken by futexwake() if *uaddr == val.
+// Returns 0 after a wakeup, -1 if the word did not hold val
+// (the caller should retry) or on error.
+int futexwait(uint uaddr, int val)
+{
+  int *key;
+
+  if ((key = futexkey(uaddr)) == 0)
+    return -1;
+
+  acquire(&futextable.lock);
+  // The compare happens under futextable.lock, and futexwake()
+  // takes the same lock, so a wake that follows the user's
+  // store to the word cannot be missed.
+  if (*(volatile int *)key != val)
+  {
+    release(&futextable.lock);
+    return -1;
+  }
+  if (myproc()->killed)
+  {
+    release(&futextable.lock);
+    return -1;
+  }
+  sleep(key, &futextable.lock);
+  release(&futextable.lock);
+  return 0;
+}
+
+// Wake at most n processes sleeping on uaddr.
+// Returns the number of processes woken, or -1 on error.
+int futexwake(uint uaddr, int n)
+{
+  int *key;
+  int woken;
+
+  if ((key = futexkey(uaddr)) == 0)
+    return -1;
+
+  acquire(&futextable.lock);
+  woken = wakeupn(key, n);
+  release(&futextable.lock);
+  return woken;
+}
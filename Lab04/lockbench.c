@@ -0,0 +1,82 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "spinlock.h"
+
+// Compare the reentrant-lock system calls with the futex-based
+// user-space rmutex on the uncontended paths test_lock exercises.
+
+#define ITERS 20000
+#define FIB_N 18
+
+struct reentrantlock klock;
+struct rmutex ulock;
+int calls;
+
+int fib_syscall(int n)
+{
+    int result;
+
+    acquire_reentrant_lock(&klock);
+    calls++;
+    if (n < 2)
+        result = n;
+    else
+        result = fib_syscall(n - 1) + fib_syscall(n - 2);
+    release_reentrant_lock(&klock);
+    return result;
+}
+
+int fib_user(int n)
+{
+    int result;
+
+    rmutex_lock(&ulock);
+    calls++;
+    if (n < 2)
+        result = n;
+    else
+        result = fib_user(n - 1) + fib_user(n - 2);
+    rmutex_unlock(&ulock);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    int i, start, t_sys, t_user, r;
+
+    init_reentrant_lock(&klock, "bench");
+    rmutex_init(&ulock);
+
+    start = uptime();
+    for (i = 0; i < ITERS; i++)
+    {
+        acquire_reentrant_lock(&klock);
+        release_reentrant_lock(&klock);
+    }
+    t_sys = uptime() - start;
+
+    start = uptime();
+    for (i = 0; i < ITERS; i++)
+    {
+        rmutex_lock(&ulock);
+        rmutex_unlock(&ulock);
+    }
+    t_user = uptime() - start;
+
+    printf(1, "lock/unlock x%d: syscall %d ticks, rmutex %d ticks\n", ITERS, t_sys, t_user);
+
+    calls = 0;
+    start = uptime();
+    r = fib_syscall(FIB_N);
+    t_sys = uptime() - start;
+    printf(1, "fib(%d)=%d with %d nested acquires: syscall %d ticks\n", FIB_N, r, calls, t_sys);
+
+    calls = 0;
+    start = uptime();
+    r = fib_user(FIB_N);
+    t_user = uptime() - start;
+    printf(1, "fib(%d)=%d with %d nested acquires: rmutex %d ticks\n", FIB_N, r, calls, t_user);
+
+    exit();
+}
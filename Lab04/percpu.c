@@ -0,0 +1,41 @@
+// Per-CPU counters.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "x86.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "percpu.h"
+
+// Add n to this CPU's slot of c.
+void
+pcpuadd(struct pcpucounter *c, int n)
+{
+  // Interrupts off keeps us on this CPU between cpuid() and the
+  // add, and keeps an interrupt handler from racing the add.
+  pushcli();
+  c->cpu[cpuid()].n += n;
+  popcli();
+}
+
+// Return CPU cpu's share of c.
+uint
+pcpureadcpu(struct pcpucounter *c, int cpu)
+{
+  return *(volatile uint*)&c->cpu[cpu].n;
+}
+
+// Return the total of c over all CPUs.
+uint
+pcpuread(struct pcpucounter *c)
+{
+  uint sum;
+  int i;
+
+  sum = 0;
+  for(i = 0; i < ncpu; i++)
+    sum += pcpureadcpu(c, i);
+  return sum;
+}
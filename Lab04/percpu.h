@@ -0,0 +1,13 @@
+// Per-CPU counters.
+// Each CPU adds only to its own slot, and each slot fills a whole
+// cache line, so the update path never writes a line that another
+// CPU writes.  Readers sum the slots; the sum is not a snapshot,
+// but no increment is ever lost.
+
+#define CACHELINE 64
+
+struct pcpucounter {
+  struct {
+    uint n;
+  } __attribute__((aligned(CACHELINE))) cpu[NCPU];
+};
@@ -90,6 +90,7 @@ allocproc(void)
 found:
   p->state = EMBRYO;
   p->pid = nextpid++;
+  p->ustack = 0;
 
   release(&ptable.lock);
 
@@ -142,6 +143,8 @@ void userinit(void)
   p->tf->eip = 0; // beginning of initcode.S
 
   safestrcpy(p->name, "initcode", sizeof(p->name));
+  if ((p->files = filesalloc()) == 0)
+    panic("userinit: no file table");
   p->cwd = namei("/");
 
   // this assignment to p->state lets other cores
@@ -157,33 +160,121 @@ void userinit(void)
 
 // Grow current process's memory by n bytes.
 // Return 0 on success, -1 on failure.
+// Threads sharing the address space share its size, so the
+// change is made under ptable.lock and copied to all of them.
 int growproc(int n)
 {
   uint sz;
   struct proc *curproc = myproc();
+  struct proc *p;
 
+  acquire(&ptable.lock);
   sz = curproc->sz;
   if (n > 0)
   {
     if ((sz = allocuvm(curproc->pgdir, sz, sz + n)) == 0)
+    {
+      release(&ptable.lock);
       return -1;
+    }
   }
   else if (n < 0)
   {
     if ((sz = deallocuvm(curproc->pgdir, sz, sz + n)) == 0)
+    {
+      release(&ptable.lock);
       return -1;
+    }
   }
-  curproc->sz = sz;
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    if (p->state != UNUSED && p->pgdir == curproc->pgdir)
+      p->sz = sz;
+  release(&ptable.lock);
   switchuvm(curproc);
   return 0;
 }
 
+// Free pgdir unless a thread still uses it.
+// Caller holds ptable.lock.
+static void
+freesharedvm(pde_t *pgdir)
+{
+  struct proc *p;
+
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    if (p->state != UNUSED && p->pgdir == pgdir)
+      return;
+  freevm(pgdir);
+}
+
+// Free an address space the current process has stopped using.
+void putvm(pde_t *pgdir)
+{
+  acquire(&ptable.lock);
+  freesharedvm(pgdir);
+  release(&ptable.lock);
+}
+
+// Called by exec() once it is committed: make pgdir the current
+// process's address space and end every other thread of the old
+// one, so that the new program runs alone.  Threads are freed
+// here, since join() no longer sees them once the address spaces
+// differ; a main thread exits and is left to its parent's wait().
+// Returns the old address space, to be released with putvm().
+pde_t *
+execvm(pde_t *pgdir)
+{
+  struct proc *curproc = myproc();
+  struct proc *p;
+  pde_t *old;
+  int alive;
+
+  acquire(&ptable.lock);
+  old = curproc->pgdir;
+  curproc->pgdir = pgdir;
+  curproc->ustack = 0;
+  for (;;)
+  {
+    alive = 0;
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+      if (p == curproc || p->state == UNUSED || p->pgdir != old)
+        continue;
+      if (p->state == ZOMBIE)
+      {
+        if (p->ustack == 0)
+          continue;
+        kfree(p->kstack);
+        p->kstack = 0;
+        p->pgdir = 0;
+        p->ustack = 0;
+        p->pid = 0;
+        p->parent = 0;
+        p->name[0] = 0;
+        p->killed = 0;
+        p->state = UNUSED;
+        continue;
+      }
+      p->killed = 1;
+      if (p->state == SLEEPING)
+        p->state = RUNNABLE;
+      if (p->ustack != 0)
+        alive = 1;
+    }
+    if (!alive)
+      break;
+    sleep(old, &ptable.lock); // exit() wakes old
+  }
+  release(&ptable.lock);
+  return old;
+}
+
 // Create a new process copying p as the parent.
 // Sets up stack to return as if from system call.
 // Caller must set state of returned proc to RUNNABLE.
 int fork(void)
 {
-  int i, pid;
+  int pid;
   struct proc *np;
   struct proc *curproc = myproc();
 
@@ -194,8 +285,17 @@ int fork(void)
   }
 
   // Copy process state from proc.
+  if ((np->files = filescopy(curproc->files)) == 0)
+  {
+    kfree(np->kstack);
+    np->kstack = 0;
+    np->state = UNUSED;
+    return -1;
+  }
   if ((np->pgdir = copyuvm(curproc->pgdir, curproc->sz)) == 0)
   {
+    filesput(np->files);
+    np->files = 0;
     kfree(np->kstack);
     np->kstack = 0;
     np->state = UNUSED;
@@ -208,9 +308,62 @@ int fork(void)
   // Clear %eax so that fork returns 0 in the child.
   np->tf->eax = 0;
 
-  for (i = 0; i < NOFILE; i++)
-    if (curproc->ofile[i])
-      np->ofile[i] = filedup(curproc->ofile[i]);
+  np->cwd = idup(curproc->cwd);
+
+  safestrcpy(np->name, curproc->name, sizeof(curproc->name));
+
+  pid = np->pid;
+
+  acquire(&ptable.lock);
+
+  np->state = RUNNABLE;
+
+  release(&ptable.lock);
+
+  return pid;
+}
+
+// Create a thread: a process that shares the current process's
+// address space.  It starts in fn(arg1, arg2) on the one-page
+// user stack at stack, and shares the file descriptor table.
+// Returns the thread's pid, or -1.
+int clone(void (*fn)(void *, void *), void *arg1, void *arg2, void *stack)
+{
+  int pid;
+  uint sp, ustack[3];
+  struct proc *np;
+  struct proc *curproc = myproc();
+
+  // A thread's ustack must not be 0, which marks a main thread.
+  if (stack == 0 || (uint)stack % PGSIZE != 0 || (uint)stack + PGSIZE > curproc->sz)
+    return -1;
+
+  if ((np = allocproc()) == 0)
+    return -1;
+
+  np->pgdir = curproc->pgdir;
+  np->sz = curproc->sz;
+  np->parent = curproc;
+  np->ustack = stack;
+  *np->tf = *curproc->tf;
+
+  // fn returns to a fake pc, like main; the user library's
+  // start routine calls exit() instead of returning.
+  ustack[0] = 0xffffffff;
+  ustack[1] = (uint)arg1;
+  ustack[2] = (uint)arg2;
+  sp = (uint)stack + PGSIZE - sizeof(ustack);
+  if (copyout(np->pgdir, sp, ustack, sizeof(ustack)) < 0)
+  {
+    kfree(np->kstack);
+    np->kstack = 0;
+    np->state = UNUSED;
+    return -1;
+  }
+  np->tf->esp = sp;
+  np->tf->eip = (uint)fn;
+
+  np->files = filesdup(curproc->files);
   np->cwd = idup(curproc->cwd);
 
   safestrcpy(np->name, curproc->name, sizeof(curproc->name));
@@ -233,20 +386,13 @@ void exit(void)
 {
   struct proc *curproc = myproc();
   struct proc *p;
-  int fd;
 
   if (curproc == initproc)
     panic("init exiting");
 
-  // Close all open files.
-  for (fd = 0; fd < NOFILE; fd++)
-  {
-    if (curproc->ofile[fd])
-    {
-      fileclose(curproc->ofile[fd]);
-      curproc->ofile[fd] = 0;
-    }
-  }
+  // Close all open files, unless threads still share them.
+  filesput(curproc->files);
+  curproc->files = 0;
 
   begin_op();
   iput(curproc->cwd);
@@ -258,6 +404,9 @@ void exit(void)
   // Parent might be sleeping in wait().
   wakeup1(curproc->parent);
 
+  // exec() might be waiting for the threads of this address space.
+  wakeup1(curproc->pgdir);
+
   // Pass abandoned children to init.
   for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
   {
@@ -269,6 +418,20 @@ void exit(void)
     }
   }
 
+  // When the main thread exits, its threads exit too.
+  if (curproc->ustack == 0)
+  {
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+      if (p != curproc && p->state != UNUSED && p->pgdir == curproc->pgdir)
+      {
+        p->killed = 1;
+        if (p->state == SLEEPING)
+          p->state = RUNNABLE;
+      }
+    }
+  }
+
   // Jump into the scheduler, never to return.
   curproc->state = ZOMBIE;
   sched();
@@ -290,7 +453,8 @@ int wait(void)
     havekids = 0;
     for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
     {
-      if (p->parent != curproc)
+      // Threads are collected by join().
+      if (p->parent != curproc || p->pgdir == curproc->pgdir)
         continue;
       havekids = 1;
       if (p->state == ZOMBIE)
@@ -299,12 +463,13 @@ int wait(void)
         pid = p->pid;
         kfree(p->kstack);
         p->kstack = 0;
-        freevm(p->pgdir);
+        p->state = UNUSED; // so freesharedvm does not count p
+        freesharedvm(p->pgdir);
+        p->pgdir = 0;
         p->pid = 0;
         p->parent = 0;
         p->name[0] = 0;
         p->killed = 0;
-        p->state = UNUSED;
         release(&ptable.lock);
         return pid;
       }
@@ -322,6 +487,55 @@ int wait(void)
   }
 }
 
+// Wait for a thread created by the current process to exit.
+// tid is the thread's pid, or 0 for any thread.  Stores the
+// thread's user stack in *stack and returns its pid, or -1 if
+// there is no such thread.
+int join(int tid, void **stack)
+{
+  struct proc *p;
+  int havethreads, pid;
+  struct proc *curproc = myproc();
+
+  acquire(&ptable.lock);
+  for (;;)
+  {
+    havethreads = 0;
+    for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+    {
+      if (p->parent != curproc || p->pgdir != curproc->pgdir)
+        continue;
+      if (tid != 0 && p->pid != tid)
+        continue;
+      havethreads = 1;
+      if (p->state == ZOMBIE)
+      {
+        pid = p->pid;
+        *stack = p->ustack;
+        kfree(p->kstack);
+        p->kstack = 0;
+        p->pgdir = 0;
+        p->ustack = 0;
+        p->pid = 0;
+        p->parent = 0;
+        p->name[0] = 0;
+        p->killed = 0;
+        p->state = UNUSED;
+        release(&ptable.lock);
+        return pid;
+      }
+    }
+
+    if (!havethreads || curproc->killed)
+    {
+      release(&ptable.lock);
+      return -1;
+    }
+
+    sleep(curproc, &ptable.lock); // exit() wakes the parent
+  }
+}
+
 // PAGEBREAK: 42
 //  Per-CPU process scheduler.
 //  Each CPU calls scheduler() after setting itself up.
@@ -482,6 +696,26 @@ void wakeup(void *chan)
   release(&ptable.lock);
 }
 
+// Wake up at most n processes sleeping on chan.
+// Returns the number of processes woken.
+int wakeupn(void *chan, int n)
+{
+  struct proc *p;
+  int woken = 0;
+
+  acquire(&ptable.lock);
+  for (p = ptable.proc; p < &ptable.proc[NPROC] && woken < n; p++)
+  {
+    if (p->state == SLEEPING && p->chan == chan)
+    {
+      p->state = RUNNABLE;
+      woken++;
+    }
+  }
+  release(&ptable.lock);
+  return woken;
+}
+
 // Kill the process with the given pid.
 // Process won't exit until it returns
 // to user space (see trap in trap.c).
@@ -542,16 +776,3 @@ void procdump(void)
     cprintf("\n");
   }
 }
-extern int globalSysCallCounter;
-int count_syscalls(void)
-{
-  int total_syscall_counts=0;
-  for (int i = 0; i < ncpu; i++)
-  {
-    cprintf("cpu%d num %d\n", i, cpus[i].SysCallCounter);
-    total_syscall_counts+=cpus[i].SysCallCounter;
-  }
-  cprintf("Sum: %d\n",total_syscall_counts);
-  cprintf("Global: %d\n",globalSysCallCounter);
-  return 0;
-}
\ No newline at end of file
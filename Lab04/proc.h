@@ -9,7 +9,6 @@ struct cpu
   int ncli;                  // Depth of pushcli nesting.
   int intena;                // Were interrupts enabled before pushcli?
   struct proc *proc;         // The process running on this cpu or null
-  int SysCallCounter;
 };
 
 extern struct cpu cpus[NCPU];
@@ -58,9 +57,10 @@ struct proc
   struct context *context;    // swtch() here to run process
   void *chan;                 // If non-zero, sleeping on chan
   int killed;                 // If non-zero, have been killed
-  struct file *ofile[NOFILE]; // Open files
+  struct files *files;        // Open files, shared by threads
   struct inode *cwd;          // Current directory
   char name[16];              // Process name (debugging)
+  char *ustack;               // User stack of a thread (see clone), or 0
 };
 
 // Process memory is laid out contiguously, low addresses first:
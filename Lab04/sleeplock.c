@@ -52,5 +52,75 @@ holdingsleep(struct sleeplock *lk)
   return r;
 }
 
+// Reader-writer sleep locks.
+// Readers share the lock; a writer holds it alone.  Waiting
+// writers keep new readers out so that a stream of readers
+// cannot starve them.
 
+void
+initrwsleeplock(struct rwsleeplock *lk, char *name)
+{
+  initlock(&lk->lk, "rw sleep lock");
+  lk->name = name;
+  lk->locked = 0;
+  lk->readers = 0;
+  lk->waitwriters = 0;
+  lk->pid = 0;
+}
+
+void
+acquiresleepread(struct rwsleeplock *lk)
+{
+  acquire(&lk->lk);
+  while (lk->locked || lk->waitwriters) {
+    sleep(lk, &lk->lk);
+  }
+  lk->readers++;
+  release(&lk->lk);
+}
+
+void
+releasesleepread(struct rwsleeplock *lk)
+{
+  acquire(&lk->lk);
+  if(lk->readers <= 0)
+    panic("releasesleepread");
+  if(--lk->readers == 0)
+    wakeup(lk);
+  release(&lk->lk);
+}
+
+void
+acquiresleepwrite(struct rwsleeplock *lk)
+{
+  acquire(&lk->lk);
+  lk->waitwriters++;
+  while (lk->locked || lk->readers) {
+    sleep(lk, &lk->lk);
+  }
+  lk->waitwriters--;
+  lk->locked = 1;
+  lk->pid = myproc()->pid;
+  release(&lk->lk);
+}
+
+void
+releasesleepwrite(struct rwsleeplock *lk)
+{
+  acquire(&lk->lk);
+  lk->locked = 0;
+  lk->pid = 0;
+  wakeup(lk);
+  release(&lk->lk);
+}
+
+int
+holdingsleepwrite(struct rwsleeplock *lk)
+{
+  int r;
 
+  acquire(&lk->lk);
+  r = lk->locked && (lk->pid == myproc()->pid);
+  release(&lk->lk);
+  return r;
+}
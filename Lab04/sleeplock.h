@@ -8,3 +8,14 @@ struct sleeplock {
   int pid;           // Process holding lock
 };
 
+// Reader-writer sleep lock: many readers or one writer.
+struct rwsleeplock {
+  uint locked;        // Is the lock held by a writer?
+  int readers;        // Number of readers holding the lock
+  int waitwriters;    // Writers sleeping for the lock
+  struct spinlock lk; // spinlock protecting this sleep lock
+
+  // For debugging:
+  char *name;         // Name of lock.
+  int pid;            // Process holding lock for writing
+};
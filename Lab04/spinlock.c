@@ -92,6 +92,99 @@ int holding(struct spinlock *lock)
   return r;
 }
 
+// Reader-writer spin locks.
+// A writer takes rw->lock like an ordinary spinlock and then
+// waits for the readers inside to drain.  A reader announces
+// itself in rw->readers and backs off if it then sees a writer,
+// so new readers cannot starve a waiting writer.
+// Read sections must not nest: a nested reader would wait
+// behind a writer that is waiting for the outer reader.
+
+void initrwlock(struct rwspinlock *rw, char *name)
+{
+  initlock(&rw->lock, name);
+  rw->readers = 0;
+}
+
+void acquireread(struct rwspinlock *rw)
+{
+  pushcli(); // disable interrupts to avoid deadlock.
+  if (holding(&rw->lock))
+    panic("acquireread");
+
+  for (;;)
+  {
+    while (*(volatile uint *)&rw->lock.locked)
+      ;
+    // The locked add is a full barrier: either the writer sees
+    // our count, or we see its lock below.
+    __sync_fetch_and_add(&rw->readers, 1);
+    if (!*(volatile uint *)&rw->lock.locked)
+      break;
+    __sync_fetch_and_sub(&rw->readers, 1);
+  }
+}
+
+void releaseread(struct rwspinlock *rw)
+{
+  if (rw->readers == 0)
+    panic("releaseread");
+  __sync_fetch_and_sub(&rw->readers, 1);
+  popcli();
+}
+
+void acquirewrite(struct rwspinlock *rw)
+{
+  acquire(&rw->lock);
+  while (*(volatile uint *)&rw->readers != 0)
+    ;
+  __sync_synchronize();
+}
+
+void releasewrite(struct rwspinlock *rw)
+{
+  release(&rw->lock);
+}
+
+// Sequence locks.  The barriers order the data accesses
+// between the two reads (or writes) of seq.
+
+void initseqlock(struct seqlock *sl)
+{
+  sl->seq = 0;
+}
+
+void seqwritebegin(struct seqlock *sl)
+{
+  sl->seq++;
+  __sync_synchronize();
+}
+
+void seqwriteend(struct seqlock *sl)
+{
+  __sync_synchronize();
+  sl->seq++;
+}
+
+// Returns the sequence number to pass to seqreadretry,
+// waiting out a write in progress.
+uint seqreadbegin(struct seqlock *sl)
+{
+  uint seq;
+
+  while ((seq = *(volatile uint *)&sl->seq) & 1)
+    ;
+  __sync_synchronize();
+  return seq;
+}
+
+// Returns 1 if a write overlapped the read that began with seq.
+int seqreadretry(struct seqlock *sl, uint seq)
+{
+  __sync_synchronize();
+  return *(volatile uint *)&sl->seq != seq;
+}
+
 // Pushcli/popcli are like cli/sti except that they are matched:
 // it takes two popcli to undo two pushcli.  Also, if interrupts
 // are off, then pushcli, popcli leaves them off.
@@ -10,6 +10,24 @@ struct spinlock
                    // that locked the lock.
 };
 
+// Reader-writer spin lock.
+// Writers hold lock; readers only count themselves in readers
+// and wait while a writer holds or is waiting for lock.
+struct rwspinlock
+{
+  struct spinlock lock; // held by the writer
+  uint readers;         // number of readers inside
+};
+
+// Sequence lock.
+// seq is odd while a write is in progress; readers copy the data
+// and retry if seq was odd or changed.  Readers never block the
+// writer or each other.  Writers must be serialized by the caller.
+struct seqlock
+{
+  uint seq;
+};
+
 struct reentrantlock
 {
   struct spinlock lock; 
@@ -6,6 +6,7 @@
 #include "proc.h"
 #include "x86.h"
 #include "syscall.h"
+#include "percpu.h"
 
 // User code makes a system call with INT T_SYSCALL.
 // System call number in %eax.
@@ -107,6 +108,11 @@ extern int sys_count_syscalls(void);
 extern int sys_init_reentrant_lock(void);
 extern int sys_acquire_reentrant_lock(void);
 extern int sys_release_reentrant_lock (void);
+extern int sys_futex_wait(void);
+extern int sys_futex_wake(void);
+extern int sys_uptime_us(void);
+extern int sys_clone(void);
+extern int sys_join(void);
 
 static int (*syscalls[])(void) = {
 [SYS_fork]    sys_fork,
@@ -134,8 +140,53 @@ static int (*syscalls[])(void) = {
 [SYS_init_reentrant_lock] sys_init_reentrant_lock,
 [SYS_acquire_reentrant_lock] sys_acquire_reentrant_lock,
 [SYS_release_reentrant_lock] sys_release_reentrant_lock,
+[SYS_futex_wait] sys_futex_wait,
+[SYS_futex_wake] sys_futex_wake,
+[SYS_uptime_us] sys_uptime_us,
+[SYS_clone] sys_clone,
+[SYS_join] sys_join,
 };
 
+// Calls of each system call, counted per CPU so that the
+// syscall path writes only cache lines private to its CPU.
+static struct pcpucounter syscallcount[NELEM(syscalls)];
+
+// Weight of a call in the count_syscalls() totals.
+static int
+syscallweight(int num)
+{
+  switch(num){
+  case SYS_open:
+    return 3;
+  case SYS_write:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+// Print per-CPU and per-call counts; return the weighted total.
+int
+count_syscalls(void)
+{
+  int i, num, n, cputotal, total;
+
+  total = 0;
+  for(i = 0; i < ncpu; i++){
+    cputotal = 0;
+    for(num = 1; num < NELEM(syscalls); num++)
+      cputotal += pcpureadcpu(&syscallcount[num], i) * syscallweight(num);
+    cprintf("cpu%d num %d\n", i, cputotal);
+    total += cputotal;
+  }
+  for(num = 1; num < NELEM(syscalls); num++){
+    if((n = pcpuread(&syscallcount[num])) > 0)
+      cprintf("syscall %d: %d\n", num, n);
+  }
+  cprintf("Sum: %d\n", total);
+  return total;
+}
+
 void
 syscall(void)
 {
@@ -144,6 +195,7 @@ syscall(void)
 
   num = curproc->tf->eax;
   if(num > 0 && num < NELEM(syscalls) && syscalls[num]) {
+    pcpuadd(&syscallcount[num], 1);
     curproc->tf->eax = syscalls[num]();
   } else {
     cprintf("%d %s: unknown sys call %d\n",
@@ -24,3 +24,9 @@
 #define SYS_init_reentrant_lock 23
 #define SYS_acquire_reentrant_lock 24
 #define SYS_release_reentrant_lock 25
+
+#define SYS_futex_wait 26
+#define SYS_futex_wake 27
+#define SYS_uptime_us 28
+#define SYS_clone 29
+#define SYS_join 30
\ No newline at end of file
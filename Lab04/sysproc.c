@@ -57,8 +57,10 @@ int sys_sleep(void)
 
   if (argint(0, &n) < 0)
     return -1;
-  acquire(&tickslock);
   ticks0 = ticks;
+  if (n <= 0)
+    return 0;
+  acquire(&tickslock);
   while (ticks - ticks0 < n)
   {
     if (myproc()->killed)
@@ -74,22 +76,29 @@ int sys_sleep(void)
 
 // return how many clock tick interrupts have occurred
 // since start.
+// ticks has a single writer and is read with one load,
+// so no lock is needed.
 int sys_uptime(void)
 {
-  uint xticks;
+  return ticks;
+}
 
-  acquire(&tickslock);
-  xticks = ticks;
-  release(&tickslock);
-  return xticks;
+// store microseconds since start in *us.
+int sys_uptime_us(void)
+{
+  uint64 *us;
+
+  if (argptr(0, (void *)&us, sizeof(*us)) < 0)
+    return -1;
+  *us = clockus();
+  return 0;
 }
 
 extern int count_syscalls(void);
 
 int sys_count_syscalls(void)
 {
-  count_syscalls();
-  return 0;
+  return count_syscalls();
 }
 
  int sys_init_reentrant_lock(void)
@@ -117,4 +126,48 @@ int sys_count_syscalls(void)
         return -1;
     releasereentrantlock(lock);
     return 0;
- }
\ No newline at end of file
+ }
+
+int sys_futex_wait(void)
+{
+  int *addr;
+  int val;
+
+  if (argptr(0, (void *)&addr, sizeof(*addr)) < 0 || argint(1, &val) < 0)
+    return -1;
+  return futexwait((uint)addr, val);
+}
+
+int sys_futex_wake(void)
+{
+  int *addr;
+  int n;
+
+  if (argptr(0, (void *)&addr, sizeof(*addr)) < 0 || argint(1, &n) < 0)
+    return -1;
+  return futexwake((uint)addr, n);
+}
+
+int sys_clone(void)
+{
+  int fn, arg1, arg2;
+  char *stack;
+
+  if (argint(0, &fn) < 0 || argint(1, &arg1) < 0 || argint(2, &arg2) < 0 ||
+      argptr(3, &stack, PGSIZE) < 0)
+    return -1;
+  return clone((void (*)(void *, void *))fn, (void *)arg1, (void *)arg2, stack);
+}
+
+int sys_join(void)
+{
+  int tid, pid;
+  void **stack;
+  void *s;
+
+  if (argint(0, &tid) < 0 || argptr(1, (void *)&stack, sizeof(*stack)) < 0)
+    return -1;
+  if ((pid = join(tid, &s)) >= 0)
+    *stack = s;
+  return pid;
+}
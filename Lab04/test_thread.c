@@ -0,0 +1,135 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "spinlock.h"
+
+// The test_lock and testmem workloads, run by threads that
+// share one address space instead of forked processes, and a
+// check that threads sharing a file table cannot close one
+// descriptor twice.
+
+#define NTHREADS 4
+#define FIB_N 10
+#define CLOSEROUNDS 100
+
+struct reentrantlock fiblock;
+int num_recursive_call = 0;
+
+struct mutex factlock;
+int factorial = 1;
+
+int fibonacci_recursive(int n)
+{
+    int result;
+
+    acquire_reentrant_lock(&fiblock);
+    num_recursive_call++;
+    if (n < 2)
+        result = n;
+    else
+        result = fibonacci_recursive(n - 1) + fibonacci_recursive(n - 2);
+    release_reentrant_lock(&fiblock);
+    return result;
+}
+
+void fib_thread(void *arg)
+{
+    int id = (int)arg;
+
+    printf(1, "thread %d: fib(%d) = %d\n", id, FIB_N, fibonacci_recursive(FIB_N));
+}
+
+void fact_thread(void *arg)
+{
+    int num = (int)arg;
+
+    mutex_lock(&factlock);
+    factorial *= num;
+    printf(1, "thread %d updated factorial to: %d\n", num, factorial);
+    mutex_unlock(&factlock);
+}
+
+int closefd;
+int closed[2];
+
+void close_thread(void *arg)
+{
+    closed[(int)arg] = close(closefd);
+}
+
+// Two threads close the same descriptor at once: exactly one
+// close must succeed, and the pipe's read end must stay open
+// through the dup of it.  Were it closed twice, the dup's
+// reference would be dropped as well.
+void close_test(void)
+{
+    int p[2], keep, i, j, ok;
+    char c;
+
+    ok = 1;
+    for (i = 0; i < CLOSEROUNDS && ok; i++)
+    {
+        if (pipe(p) < 0 || (keep = dup(p[0])) < 0)
+        {
+            printf(2, "test_thread: pipe failed\n");
+            exit();
+        }
+        closefd = p[0];
+        for (j = 0; j < 2; j++)
+            thread_create(close_thread, (void *)j);
+        for (j = 0; j < 2; j++)
+            thread_join(0);
+        if ((closed[0] == 0) + (closed[1] == 0) != 1)
+        {
+            printf(1, "close race: %d and %d\n", closed[0], closed[1]);
+            ok = 0;
+        }
+        if (write(p[1], "x", 1) != 1 || read(keep, &c, 1) != 1)
+        {
+            printf(1, "close race: dup lost its reference\n");
+            ok = 0;
+        }
+        close(keep);
+        close(p[1]);
+    }
+    printf(1, "close race: %s\n", ok ? "ok" : "FAILED");
+}
+
+int main(int argc, char *argv[])
+{
+    int i, calls, expect;
+
+    init_reentrant_lock(&fiblock, "fiblock");
+    for (i = 0; i < NTHREADS; i++)
+    {
+        if (thread_create(fib_thread, (void *)i) < 0)
+        {
+            printf(2, "test_thread: thread_create failed\n");
+            exit();
+        }
+    }
+    for (i = 0; i < NTHREADS; i++)
+        thread_join(0);
+
+    // fib(n) makes 2 * fib(n + 1) - 1 calls.
+    calls = 1;
+    expect = 1;
+    for (i = 2; i <= FIB_N + 1; i++)
+    {
+        int t = calls + expect;
+        calls = expect;
+        expect = t;
+    }
+    expect = NTHREADS * (2 * expect - 1);
+    printf(1, "recursive calls: %d (expected %d)\n", num_recursive_call, expect);
+
+    mutex_init(&factlock);
+    for (i = 1; i <= NTHREADS; i++)
+        thread_create(fact_thread, (void *)i);
+    for (i = 1; i <= NTHREADS; i++)
+        thread_join(0);
+    printf(1, "factorial of %d: %d\n", NTHREADS, factorial);
+
+    close_test();
+    exit();
+}
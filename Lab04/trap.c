@@ -8,8 +8,6 @@
 #include "traps.h"
 #include "spinlock.h"
 
-int globalSysCallCounter = 0;
-
 // Interrupt descriptor table (shared by all CPUs).
 struct gatedesc idt[256];
 extern uint vectors[]; // in vectors.S: array of 256 entry pointers
@@ -41,28 +39,6 @@ void trap(struct trapframe *tf)
       exit();
     myproc()->tf = tf;
     syscall();
-
-    uint current_pid = tf->eax;
-    int new_sys_call_count;
-    switch(current_pid)
-    {
-      case 15: 
-      new_sys_call_count = 3;
-      break;
-
-      case 16:
-      new_sys_call_count = 2;
-      break;
-
-      default:
-      new_sys_call_count = 1;
-      break;
-    }
-    pushcli();
-    struct cpu* current_cpu = mycpu();
-    current_cpu->SysCallCounter += new_sys_call_count;
-    popcli();
-    globalSysCallCounter += new_sys_call_count;
     if (myproc()->killed)
       exit();
     return;
@@ -73,8 +49,11 @@ void trap(struct trapframe *tf)
   case T_IRQ0 + IRQ_TIMER:
     if (cpuid() == 0)
     {
+      // clocktick() advances ticks before tickslock is taken,
+      // so a sleeper that saw the old value under tickslock is
+      // already asleep when the wakeup runs.
+      clocktick();
       acquire(&tickslock);
-      ticks++;
       wakeup(&ticks);
       release(&tickslock);
     }
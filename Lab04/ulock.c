@@ -0,0 +1,101 @@
+// User-space mutexes built on futex_wait/futex_wake.
+//
+// The uncontended path is a single atomic instruction; the
+// kernel is entered only when a lock has to wait or has waiters
+// to wake.  The state word follows Drepper, "Futexes Are Tricky":
+//   0  unlocked
+//   1  locked, no waiters
+//   2  locked, maybe waiters
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "x86.h"
+
+#define USTACKSIZE 4096  // user stacks are one page (see exec.c)
+
+void
+mutex_init(struct mutex *m)
+{
+  m->state = 0;
+}
+
+int
+mutex_trylock(struct mutex *m)
+{
+  return cmpxchg(&m->state, 0, 1) == 0;
+}
+
+void
+mutex_lock(struct mutex *m)
+{
+  uint c;
+
+  if((c = cmpxchg(&m->state, 0, 1)) == 0)
+    return;
+
+  // Contended: advertise a waiter, then sleep until the
+  // holder hands the lock back with state 0.
+  if(c != 2)
+    c = xchg(&m->state, 2);
+  while(c != 0){
+    futex_wait(&m->state, 2);
+    c = xchg(&m->state, 2);
+  }
+}
+
+void
+mutex_unlock(struct mutex *m)
+{
+  if(xchg(&m->state, 0) == 2)
+    futex_wake(&m->state, 1);
+}
+
+// Identify the calling thread without a system call.
+// Every thread runs on its own one-page stack, so the page
+// holding %esp names the thread within its address space.
+static uint
+self(void)
+{
+  uint esp;
+
+  asm volatile("movl %%esp, %0" : "=r" (esp));
+  return esp & ~(USTACKSIZE - 1);
+}
+
+void
+rmutex_init(struct rmutex *rm)
+{
+  mutex_init(&rm->m);
+  rm->owner = 0;
+  rm->recursion = 0;
+}
+
+void
+rmutex_lock(struct rmutex *rm)
+{
+  uint me = self();
+
+  // Only the owner can observe owner == me, so this read
+  // needs no atomic instruction.
+  if(rm->owner == me){
+    rm->recursion++;
+    return;
+  }
+  mutex_lock(&rm->m);
+  rm->owner = me;
+  rm->recursion = 1;
+}
+
+void
+rmutex_unlock(struct rmutex *rm)
+{
+  if(rm->owner != self()){
+    printf(2, "rmutex_unlock: not the owner\n");
+    exit();
+  }
+  if(--rm->recursion > 0)
+    return;
+  rm->owner = 0;
+  mutex_unlock(&rm->m);
+}
@@ -42,3 +42,33 @@ int count_syscalls(void);
 int init_reentrant_lock(struct reentrantlock *rlock, char *name);
 int acquire_reentrant_lock(struct reentrantlock *rlock);
 int release_reentrant_lock(struct reentrantlock *rlock);
+int futex_wait(volatile uint *, uint);
+int futex_wake(volatile uint *, int);
+int uptime_us(uint64 *);
+int clone(void (*)(void *, void *), void *, void *, void *);
+int join(int, void **);
+
+// ulock.c
+struct mutex
+{
+  volatile uint state; // 0 free, 1 held, 2 held with waiters
+};
+
+struct rmutex
+{
+  struct mutex m;
+  volatile uint owner; // stack page of the holding thread, 0 if free
+  int recursion;       // nested acquisitions by owner
+};
+
+void mutex_init(struct mutex *);
+int mutex_trylock(struct mutex *);
+void mutex_lock(struct mutex *);
+void mutex_unlock(struct mutex *);
+void rmutex_init(struct rmutex *);
+void rmutex_lock(struct rmutex *);
+void rmutex_unlock(struct rmutex *);
+
+// uthread.c
+int thread_create(void (*)(void *), void *);
+int thread_join(int);
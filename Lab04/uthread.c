@@ -0,0 +1,52 @@
+// Threads on top of the clone and join system calls.
+//
+// Each thread runs on a one-page stack taken from malloc,
+// page-aligned so that rmutex can name a thread by its stack
+// page.  The malloc'ed block is remembered in the word just
+// below the stack so that thread_join can free it.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+#define PGSIZE 4096
+
+static void
+start(void *fn, void *arg)
+{
+  ((void (*)(void *))fn)(arg);
+  exit();
+}
+
+// Run fn(arg) in a new thread; returns its id, or -1.
+int
+thread_create(void (*fn)(void *), void *arg)
+{
+  char *mem, *stack;
+  int tid;
+
+  // malloc returns 8-byte aligned blocks, so there is always
+  // room for a pointer between mem and stack.
+  if((mem = malloc(2 * PGSIZE)) == 0)
+    return -1;
+  stack = (char*)(((uint)mem + PGSIZE) & ~(PGSIZE - 1));
+  ((char**)stack)[-1] = mem;
+  if((tid = clone(start, (void*)fn, arg, stack)) < 0){
+    free(mem);
+    return -1;
+  }
+  return tid;
+}
+
+// Wait for thread tid (0 for any thread) to exit.
+// Returns its id, or -1 if there is no such thread.
+int
+thread_join(int tid)
+{
+  void *stack;
+
+  if((tid = join(tid, &stack)) < 0)
+    return -1;
+  free(((char**)stack)[-1]);
+  return tid;
+}
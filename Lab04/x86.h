@@ -115,6 +115,27 @@ xchg(volatile uint *addr, uint newval)
   return result;
 }
 
+// Atomically set *addr to newval if it equals expected.
+// Returns the value *addr held before the operation.
+static inline uint
+cmpxchg(volatile uint *addr, uint expected, uint newval)
+{
+  uint result;
+
+  asm volatile("lock; cmpxchgl %2, %1" : "=a"(result), "+m"(*addr) : "r"(newval), "0"(expected) : "memory", "cc");
+  return result;
+}
+
+// Read the time-stamp counter.
+static inline uint64
+rdtsc(void)
+{
+  uint lo, hi;
+
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return ((uint64)hi << 32) | lo;
+}
+
 static inline uint
 rcr2(void)
 {
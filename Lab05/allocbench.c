@@ -0,0 +1,53 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Page allocator throughput as parallel processes are added.
+// Each worker repeatedly grows its heap, touches every new page
+// (one kalloc each) and shrinks it again (one kfree each).  With
+// per-CPU page caches the time should stay flat up to the number
+// of CPUs (make qemu CPUS=4).
+
+#define PAGE 4096
+#define CHUNK (64 * PAGE)
+#define ROUNDS 200
+
+int nprocs[] = {1, 2, 4, 8};
+
+void worker(void)
+{
+    char *mem;
+    int i, j;
+
+    for (i = 0; i < ROUNDS; i++)
+    {
+        if ((mem = sbrk(CHUNK)) == (char *)-1)
+        {
+            printf(1, "allocbench: sbrk failed\n");
+            exit();
+        }
+        for (j = 0; j < CHUNK; j += PAGE)
+            mem[j] = 1;
+        sbrk(-CHUNK);
+    }
+    exit();
+}
+
+int main(int argc, char *argv[])
+{
+    int i, j, n, start, t;
+
+    for (i = 0; i < sizeof(nprocs) / sizeof(nprocs[0]); i++)
+    {
+        n = nprocs[i];
+        start = uptime();
+        for (j = 0; j < n; j++)
+            if (fork() == 0)
+                worker();
+        for (j = 0; j < n; j++)
+            wait();
+        t = uptime() - start;
+        printf(1, "%d procs: %d pages each, %d ticks\n", n, ROUNDS * CHUNK / PAGE, t);
+    }
+    exit();
+}
@@ -2,8 +2,13 @@ struct buf;
 struct context;
 struct file;
 struct inode;
+struct kmem_cache;
 struct pipe;
 struct proc;
+struct vma;
+struct shminfo;
+struct memstat;
+struct slabstat;
 struct rtcdate;
 struct spinlock;
 struct sleeplock;
@@ -24,6 +29,7 @@ void panic(char *) __attribute__((noreturn));
 
 // exec.c
 int exec(char *, char **);
+int execfault(uint);
 
 // file.c
 struct file *filealloc(void);
@@ -38,6 +44,7 @@ int filewrite(struct file *, char *, int n);
 void readsb(int dev, struct superblock *sb);
 int dirlink(struct inode *, char *, uint);
 struct inode *dirlookup(struct inode *, char *, uint *);
+uint dirinum(struct inode *, char *, uint *);
 struct inode *ialloc(uint, short);
 struct inode *idup(struct inode *);
 void iinit(int dev);
@@ -68,10 +75,53 @@ char *kalloc(void);
 void kfree(char *);
 void kinit1(void *, void *);
 void kinit2(void *, void *);
+void kref(char *);
+int krefcount(char *);
+char *kzalloc(void);
+int kzerofill(void);
+char *superalloc(void);
+void superfree(char *);
+void kmemstat(struct memstat *);
 
 // kbd.c
 void kbdintr(void);
 
+// ksync.c
+void ksyncinit(void);
+int semcreate(int);
+int semwait(int);
+int sempost(int);
+int condcreate(void);
+int condwait(int, int);
+int condsignal(int, int);
+int barriercreate(int);
+int barrierwait(int);
+int ksyncfree(int);
+
+// vma.c
+void vmainit(struct proc *);
+int vmaoverlaps(struct proc *, uint, uint);
+struct vma *vmaadd(struct proc *, int, uint, uint);
+struct vma *vmaplace(struct proc *, int, uint, uint);
+struct vma *vmafind(struct proc *, uint);
+struct vma *vmaget(struct proc *, int);
+void vmafree(struct vma *);
+void vmaiput(struct proc *);
+int vmareserved(struct proc *);
+int vmaaccess(uint, uint, int);
+
+// mmap.c
+void pcacheinit(void);
+char *pcachetext(struct inode *, uint, uint);
+void pcachesync(struct inode *, uint, uint);
+void pcachedrop(struct inode *);
+int pcachecount(void);
+int mmap_file(struct file *, uint, int, int, int, int);
+int munmap_file(uint, int);
+void close_all_mmap(struct proc *);
+int fork_mmap(struct proc *, struct proc *);
+int mmap_fault(uint, uint);
+
 // lapic.c
 void cmostime(struct rtcdate *r);
 int lapicid(void);
@@ -107,11 +157,13 @@ int cpuid(void);
 void exit(void);
 int fork(void);
 int growproc(int);
+int heapfault(uint);
 int kill(int);
 struct cpu *mycpu(void);
 struct proc *myproc();
 void pinit(void);
 void procdump(void);
+void procmemstat(struct memstat *);
 void scheduler(void) __attribute__((noreturn));
 void sched(void);
 void setproc(struct proc *);
@@ -133,6 +185,16 @@ void release(struct spinlock *);
 void pushcli(void);
 void popcli(void);
 
+// slab.c
+void slabinit(void);
+struct kmem_cache *kmem_cache_create(char *, uint);
+void *kmem_cache_alloc(struct kmem_cache *);
+void kmem_cache_free(struct kmem_cache *, void *);
+void *kmalloc(uint);
+void kmfree(void *);
+int slabstat(struct slabstat *, int);
+void slabdump(void);
+
 // sleeplock.c
 void acquiresleep(struct sleeplock *);
 void releasesleep(struct sleeplock *);
@@ -151,6 +213,7 @@ char *strncpy(char *, const char *, int);
 // syscall.c
 int argint(int, int *);
 int argptr(int, char **, int);
+int argoutptr(int, char **, int);
 int argstr(int, char **);
 int fetchint(uint, int *);
 int fetchstr(uint, char **);
@@ -164,6 +227,7 @@ void idtinit(void);
 extern uint ticks;
 void tvinit(void);
 extern struct spinlock tickslock;
+void faultstat(uint *);
 
 // uart.c
 void uartinit(void);
@@ -185,11 +249,22 @@ void switchuvm(struct proc *);
 void switchkvm(void);
 int copyout(pde_t *, uint, void *, uint);
 void clearpteu(pde_t *pgdir, char *uva);
+int cowfault(pde_t *, uint);
+int uvmresident(pde_t *);
+int uvmpgtables(pde_t *);
+int mapsuper(pde_t *, uint, uint, int);
 
 // lab 5
 typedef uint pte_t;
-void get_sharedmem(int, char **);
-void dump_sharedmem(int);
+void init_shared_memory_table(void);
+int get_sharedmem(int, int, char **);
+int dump_sharedmem(int);
+int sharedmem_fault(uint);
+int open_named_sharedmem(char *, int, int, char **);
+int stat_sharedmem(int, struct shminfo *);
+void shmmemstat(struct memstat *);
+void close_all_sharedmem(struct proc *);
+int fork_sharedmem(struct proc *, struct proc *);
 void get_sharedmem_lock(int);
 void let_sharedmem_lock(int);
 int mappages(pde_t *, void *, uint, uint, int);
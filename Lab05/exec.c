@@ -7,15 +7,18 @@
 #include "x86.h"
 #include "elf.h"
 
+#define MAXSEG (NVMA-2)  // leave areas for the stack and heap
+
 int
 exec(char *path, char **argv)
 {
   char *s, *last;
-  int i, off;
-  uint argc, sz, sp, ustack[3+MAXARG+1];
+  int i, off, nseg;
+  uint argc, sz, textsz, sp, ustack[3+MAXARG+1];
   struct elfhdr elf;
-  struct inode *ip;
-  struct proghdr ph;
+  struct inode *ip, *prog;
+  struct proghdr ph, seg[MAXSEG];
+  struct vma *v;
   pde_t *pgdir, *oldpgdir;
   struct proc *curproc = myproc();
 
@@ -28,6 +31,7 @@ exec(char *path, char **argv)
   }
   ilock(ip);
   pgdir = 0;
+  prog = 0;
 
   // Check ELF header
   if(readi(ip, (char*)&elf, 0, sizeof(elf)) != sizeof(elf))
@@ -38,8 +42,10 @@ exec(char *path, char **argv)
   if((pgdir = setupkvm()) == 0)
     goto bad;
 
-  // Load program into memory.
+  // lab 5: record the program segments; execfault reads
+  // their pages from the file when they are first touched.
   sz = 0;
+  nseg = 0;
   for(i=0, off=elf.phoff; i<elf.phnum; i++, off+=sizeof(ph)){
     if(readi(ip, (char*)&ph, off, sizeof(ph)) != sizeof(ph))
       goto bad;
@@ -49,13 +55,14 @@ exec(char *path, char **argv)
       goto bad;
     if(ph.vaddr + ph.memsz < ph.vaddr)
       goto bad;
-    if((sz = allocuvm(pgdir, sz, ph.vaddr + ph.memsz)) == 0)
-      goto bad;
-    if(ph.vaddr % PGSIZE != 0)
+    if(ph.vaddr % PGSIZE != 0 || ph.vaddr < sz)
       goto bad;
-    if(loaduvm(pgdir, (char*)ph.vaddr, ip, ph.off, ph.filesz) < 0)
+    if(ph.vaddr + ph.memsz > SHMTOP || nseg == MAXSEG)
       goto bad;
+    seg[nseg++] = ph;
+    sz = ph.vaddr + ph.memsz;
   }
+  prog = idup(ip);
   iunlockput(ip);
   end_op();
   ip = 0;
@@ -63,6 +70,7 @@ exec(char *path, char **argv)
   // Allocate two pages at the next page boundary.
   // Make the first inaccessible.  Use the second as the user stack.
   sz = PGROUNDUP(sz);
+  textsz = sz;
   if((sz = allocuvm(pgdir, sz, sz + 2*PGSIZE)) == 0)
     goto bad;
   clearpteu(pgdir, (char*)(sz - 2*PGSIZE));
@@ -94,13 +102,28 @@ exec(char *path, char **argv)
   safestrcpy(curproc->name, last, sizeof(curproc->name));
 
   // Commit to the user image.
+  close_all_sharedmem(curproc);
+  close_all_mmap(curproc);
+  vmaiput(curproc);
   oldpgdir = curproc->pgdir;
   curproc->pgdir = pgdir;
   curproc->sz = sz;
+  vmainit(curproc);
+  for(i = 0; i < nseg; i++){
+    v = vmaadd(curproc, VMA_TEXT, seg[i].vaddr, PGROUNDUP(seg[i].vaddr + seg[i].memsz));
+    v->ip = idup(prog);
+    v->off = seg[i].off;
+    v->filesz = seg[i].filesz;
+  }
+  vmaadd(curproc, VMA_STACK, textsz, sz);
+  vmaadd(curproc, VMA_HEAP, sz, sz);
   curproc->tf->eip = elf.entry;  // main
   curproc->tf->esp = sp;
   switchuvm(curproc);
   freevm(oldpgdir);
+  begin_op();
+  iput(prog);
+  end_op();
   return 0;
 
  bad:
@@ -110,5 +133,50 @@ exec(char *path, char **argv)
     iunlockput(ip);
     end_op();
   }
+  if(prog){
+    begin_op();
+    iput(prog);
+    end_op();
+  }
   return -1;
 }
+
+// lab 5: page fault at va in the current process.  If va lies
+// in a program segment, map its page.  Pages with file bytes
+// come from the page cache, shared with every process running
+// the program and copied on the first write (the segment is
+// also the data); pages wholly in bss get a zeroed frame.
+// Returns -1 if va is not in a segment, is already mapped, or
+// memory is exhausted.
+int
+execfault(uint va)
+{
+  struct proc *curproc = myproc();
+  struct vma *v;
+  pte_t *pte;
+  char *mem;
+  uint o, n;
+  int perm;
+
+  if((v = vmafind(curproc, va)) == 0 || v->type != VMA_TEXT || v->ip == 0)
+    return -1;
+  va = PGROUNDDOWN(va);
+  if((pte = walkpgdir(curproc->pgdir, (char*)va, 0)) != 0 && (*pte & PTE_P))
+    return -1;
+  o = va - v->start;
+  if(o < v->filesz){
+    n = v->filesz - o < PGSIZE ? v->filesz - o : PGSIZE;
+    if((mem = pcachetext(v->ip, v->off + o, n)) == 0)
+      return -1;
+    perm = PTE_U|PTE_COW;
+  } else {
+    if((mem = kzalloc()) == 0)
+      return -1;
+    perm = PTE_W|PTE_U;
+  }
+  if(mappages(curproc->pgdir, (char*)va, PGSIZE, V2P(mem), perm) < 0){
+    kfree(mem);
+    return -1;
+  }
+  return 0;
+}
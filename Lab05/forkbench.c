@@ -0,0 +1,65 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// fork+exit+wait cost as the parent grows.  With copy-on-write
+// fork the plain column should stay flat; the second column has
+// the child write every page, paying the copying that an eager
+// fork would pay up front.
+
+#define ROUNDS 50
+#define PAGE 4096
+
+int kb[] = {0, 64, 256, 1024, 4096};
+
+int run(char *mem, int bytes, int touch)
+{
+    int i, j, start;
+
+    start = uptime();
+    for (i = 0; i < ROUNDS; i++)
+    {
+        if (fork() == 0)
+        {
+            if (touch)
+                for (j = 0; j < bytes; j += PAGE)
+                    mem[j] = 2;
+            exit();
+        }
+        wait();
+    }
+    return uptime() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    char *mem;
+    int i, j, grown, bytes;
+
+    grown = 0;
+    mem = sbrk(0);
+    printf(1, "%d forks per size, ticks:\n", ROUNDS);
+    printf(1, "KB\tfork\tfork+write\n");
+    for (i = 0; i < sizeof(kb) / sizeof(kb[0]); i++)
+    {
+        bytes = kb[i] * 1024;
+        if (sbrk(bytes - grown) == (char *)-1)
+        {
+            printf(1, "forkbench: sbrk failed\n");
+            exit();
+        }
+        grown = bytes;
+        for (j = 0; j < bytes; j += PAGE)
+            mem[j] = 1;
+        printf(1, "%d\t%d\t%d\n", kb[i], run(mem, bytes, 0), run(mem, bytes, 1));
+        for (j = 0; j < bytes; j += PAGE)
+        {
+            if (mem[j] != 1)
+            {
+                printf(1, "forkbench: child write leaked into parent\n");
+                exit();
+            }
+        }
+    }
+    exit();
+}
@@ -159,24 +159,29 @@ bfree(int dev, uint b)
 // and ip->dev and ip->inum indicate which i-node an entry
 // holds, one must hold icache.lock while using any of those fields.
 //
+// lab 5: entries come from a slab cache and live on the
+// icache.inodes list.  The last iput keeps a valid entry there,
+// most recently used first, so looking the inode up again does
+// not read the disk; up to NINODE such idle entries are kept,
+// and iget recycles the least recently used one when that many
+// are cached or memory is short.
+//
 // An ip->lock sleep-lock protects all ip-> fields other than ref,
 // dev, and inum.  One must hold ip->lock in order to
 // read or write that inode's ip->valid, ip->size, ip->type, &c.
 
 struct {
   struct spinlock lock;
-  struct inode inode[NINODE];
+  struct inode *inodes;      // in-memory inodes, linked by next
+  struct kmem_cache *cache;
+  int nidle;                 // entries with ref 0
 } icache;
 
 void
 iinit(int dev)
 {
-  int i = 0;
-  
   initlock(&icache.lock, "icache");
-  for(i = 0; i < NINODE; i++) {
-    initsleeplock(&icache.inode[i].lock, "inode");
-  }
+  icache.cache = kmem_cache_create("inode", sizeof(struct inode));
 
   readsb(dev, &sb);
   cprintf("sb: size %d nblocks %d ninodes %d nlog %d logstart %d\
@@ -190,11 +195,13 @@ static struct inode* iget(uint dev, uint inum);
 //PAGEBREAK!
 // Allocate an inode on device dev.
 // Mark it as allocated by  giving it type type.
-// Returns an unlocked but allocated and referenced inode.
+// Returns an unlocked but allocated and referenced inode,
+// or 0 if there is no memory for it.
 struct inode*
 ialloc(uint dev, short type)
 {
   int inum;
+  struct inode *ip;
   struct buf *bp;
   struct dinode *dip;
 
@@ -202,11 +209,15 @@ ialloc(uint dev, short type)
     bp = bread(dev, IBLOCK(inum, sb));
     dip = (struct dinode*)bp->data + inum%IPB;
     if(dip->type == 0){  // a free inode
+      if((ip = iget(dev, inum)) == 0){
+        brelse(bp);
+        return 0;
+      }
       memset(dip, 0, sizeof(*dip));
       dip->type = type;
       log_write(bp);   // mark it allocated on the disk
       brelse(bp);
-      return iget(dev, inum);
+      return ip;
     }
     brelse(bp);
   }
@@ -238,30 +249,40 @@ iupdate(struct inode *ip)
 // Find the inode with number inum on device dev
 // and return the in-memory copy. Does not lock
 // the inode and does not read it from disk.
+// Returns 0 if there is no memory for a cache entry.
 static struct inode*
 iget(uint dev, uint inum)
 {
-  struct inode *ip, *empty;
+  struct inode *ip, *idle;
 
   acquire(&icache.lock);
 
   // Is the inode already cached?
-  empty = 0;
-  for(ip = &icache.inode[0]; ip < &icache.inode[NINODE]; ip++){
-    if(ip->ref > 0 && ip->dev == dev && ip->inum == inum){
-      ip->ref++;
+  idle = 0;
+  for(ip = icache.inodes; ip != 0; ip = ip->next){
+    if(ip->dev == dev && ip->inum == inum){
+      if(ip->ref++ == 0)
+        icache.nidle--;
       release(&icache.lock);
       return ip;
     }
-    if(empty == 0 && ip->ref == 0)    // Remember empty slot.
-      empty = ip;
+    if(ip->ref == 0)    // Remember the least recently used idle entry.
+      idle = ip;
   }
 
-  // Recycle an inode cache entry.
-  if(empty == 0)
-    panic("iget: no inodes");
-
-  ip = empty;
+  // Allocate an inode cache entry, or recycle an idle one.
+  if(icache.nidle >= NINODE || (ip = kmem_cache_alloc(icache.cache)) == 0){
+    if(idle == 0){
+      release(&icache.lock);
+      return 0;
+    }
+    ip = idle;
+    icache.nidle--;
+  } else {
+    initsleeplock(&ip->lock, "inode");
+    ip->next = icache.inodes;
+    icache.inodes = ip;
+  }
   ip->dev = dev;
   ip->inum = inum;
   ip->ref = 1;
@@ -322,8 +343,9 @@ iunlock(struct inode *ip)
 }
 
 // Drop a reference to an in-memory inode.
-// If that was the last reference, the inode cache entry can
-// be recycled.
+// If that was the last reference, the inode cache entry is
+// kept for reuse, or freed if it holds nothing worth keeping
+// or too many are idle.
 // If that was the last reference and the inode has no links
 // to it, free the inode (and its content) on disk.
 // All calls to iput() must be inside a transaction in
@@ -331,6 +353,8 @@ iunlock(struct inode *ip)
 void
 iput(struct inode *ip)
 {
+  struct inode **pp, **lru;
+
   acquiresleep(&ip->lock);
   if(ip->valid && ip->nlink == 0){
     acquire(&icache.lock);
@@ -339,6 +363,7 @@ iput(struct inode *ip)
     if(r == 1){
       // inode has no links and no other references: truncate and free.
       itrunc(ip);
+      pcachedrop(ip); // lab 5
       ip->type = 0;
       iupdate(ip);
       ip->valid = 0;
@@ -347,7 +372,30 @@ iput(struct inode *ip)
   releasesleep(&ip->lock);
 
   acquire(&icache.lock);
-  ip->ref--;
+  if(--ip->ref == 0){
+    for(pp = &icache.inodes; *pp != ip; pp = &(*pp)->next)
+      ;
+    *pp = ip->next;
+    if(ip->valid){
+      // Move to the front: the list's idle entries stay in
+      // least recently used order, oldest last.
+      ip->next = icache.inodes;
+      icache.inodes = ip;
+      if(++icache.nidle <= NINODE)
+        ip = 0;
+      else {
+        lru = 0;
+        for(pp = &icache.inodes; *pp != 0; pp = &(*pp)->next)
+          if((*pp)->ref == 0)
+            lru = pp;
+        ip = *lru;
+        *lru = ip->next;
+        icache.nidle--;
+      }
+    }
+    if(ip)
+      kmem_cache_free(icache.cache, ip);
+  }
   release(&icache.lock);
 }
 
@@ -520,11 +568,13 @@ namecmp(const char *s, const char *t)
 }
 
 // Look for a directory entry in a directory.
-// If found, set *poff to byte offset of entry.
-struct inode*
-dirlookup(struct inode *dp, char *name, uint *poff)
+// If found, set *poff to byte offset of entry and return its
+// inode number; return 0 if not found.  Needs no memory, so
+// unlike dirlookup it cannot fail.
+uint
+dirinum(struct inode *dp, char *name, uint *poff)
 {
-  uint off, inum;
+  uint off;
   struct dirent de;
 
   if(dp->type != T_DIR)
@@ -539,27 +589,38 @@ dirlookup(struct inode *dp, char *name, uint *poff)
       // entry matches path element
       if(poff)
         *poff = off;
-      inum = de.inum;
-      return iget(dp->dev, inum);
+      return de.inum;
     }
   }
 
   return 0;
 }
 
+// Look for a directory entry in a directory.
+// If found, set *poff to byte offset of entry.
+// lab 5: returns 0 if name is not found or there is no memory
+// for its inode; callers that must tell the two apart check
+// dirinum() as well.
+struct inode*
+dirlookup(struct inode *dp, char *name, uint *poff)
+{
+  uint inum;
+
+  if((inum = dirinum(dp, name, poff)) == 0)
+    return 0;
+  return iget(dp->dev, inum);
+}
+
 // Write a new directory entry (name, inum) into the directory dp.
 int
 dirlink(struct inode *dp, char *name, uint inum)
 {
   int off;
   struct dirent de;
-  struct inode *ip;
 
   // Check that name is not present.
-  if((ip = dirlookup(dp, name, 0)) != 0){
-    iput(ip);
+  if(dirinum(dp, name, 0) != 0)
     return -1;
-  }
 
   // Look for an empty dirent.
   for(off = 0; off < dp->size; off += sizeof(de)){
@@ -626,9 +687,10 @@ namex(char *path, int nameiparent, char *name)
 {
   struct inode *ip, *next;
 
-  if(*path == '/')
-    ip = iget(ROOTDEV, ROOTINO);
-  else
+  if(*path == '/'){
+    if((ip = iget(ROOTDEV, ROOTINO)) == 0)
+      return 0;
+  } else
     ip = idup(myproc()->cwd);
 
   while((path = skipelem(path, name)) != 0){
@@ -3,15 +3,81 @@
 #include "types.h"
 #include "stat.h"
 #include "user.h"
+#include "mman.h"
+
+// Lines end at '\n' as well as at '\0', so mapped files
+// can be matched in place.
+#define EOL(c) ((c) == '\0' || (c) == '\n')
+
+#define PAGE 4096
+#define WINDOW (16*PAGE)  // bytes of a file mapped at a time
 
 char buf[1024];
 int match(char*, char*);
 
+// lab 5: grep n bytes of a mapped file without copying them.
+// The byte after the last line must be readable.
+void
+grepmem(char *pattern, char *p, int n)
+{
+  char *q, *end;
+
+  for(end = p + n; p < end; p = q+1){
+    for(q = p; q < end && *q != '\n'; q++)
+      ;
+    if(match(pattern, p))
+      write(1, p, q < end ? q+1 - p : q - p);
+  }
+}
+
+// lab 5: grep the regular file fd of size bytes in place, a
+// window of its pages at a time, so a large file does not need
+// many pages mapped at once.  A window's last partial line is
+// left for the next, which starts at that line's page.  Returns
+// the bytes grepped; the rest is left to read(), as is a line
+// longer than a window or a last line that fills its page (the
+// byte after it must be readable).
+int
+grepmapped(char *pattern, int fd, uint size)
+{
+  uint start, base, len, n;
+  char *map, *p, *q;
+
+  for(start = 0; start < size; start += n){
+    base = start & ~(PAGE-1);
+    len = size - base < WINDOW ? size - base : WINDOW;
+    if((map = mmap(0, len, PROT_READ, MAP_PRIVATE, fd, base)) == MAP_FAILED)
+      break;
+    p = map + (start - base);
+    q = map + len;
+    if(base + len < size || (size % PAGE == 0 && q[-1] != '\n')){
+      while(q > p && q[-1] != '\n')
+        q--;
+    }
+    n = q - p;
+    grepmem(pattern, p, n);
+    munmap(map, len);
+    if(n == 0)
+      break;
+  }
+  return start;
+}
+
 void
 grep(char *pattern, int fd)
 {
-  int n, m;
+  int n, m, skip;
   char *p, *q;
+  struct stat st;
+
+  skip = 0;
+  if(fstat(fd, &st) == 0 && st.type == T_FILE){
+    if((skip = grepmapped(pattern, fd, st.size)) == st.size)
+      return;
+  }
+  for(; skip > 0; skip -= n)
+    if((n = read(fd, buf, skip < sizeof(buf) ? skip : sizeof(buf))) <= 0)
+      return;
 
   m = 0;
   while((n = read(fd, buf+m, sizeof(buf)-m-1)) > 0){
@@ -77,7 +143,7 @@ match(char *re, char *text)
   do{  // must look at empty string
     if(matchhere(re, text))
       return 1;
-  }while(*text++ != '\0');
+  }while(!EOL(*text++));
   return 0;
 }
 
@@ -89,8 +155,8 @@ int matchhere(char *re, char *text)
   if(re[1] == '*')
     return matchstar(re[0], re+2, text);
   if(re[0] == '$' && re[1] == '\0')
-    return *text == '\0';
-  if(*text!='\0' && (re[0]=='.' || re[0]==*text))
+    return EOL(*text);
+  if(!EOL(*text) && (re[0]=='.' || re[0]==*text))
     return matchhere(re+1, text+1);
   return 0;
 }
@@ -101,7 +167,7 @@ int matchstar(int c, char *re, char *text)
   do{  // a * matches zero or more instances
     if(matchhere(re, text))
       return 1;
-  }while(*text!='\0' && (*text++==c || c=='.'));
+  }while(!EOL(*text) && (*text++==c || c=='.'));
   return 0;
 }
 
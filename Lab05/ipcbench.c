@@ -0,0 +1,166 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "uatomic.h"
+#include "uring.h"
+
+// Moves NMSG messages of each size from a child to the parent
+// through a pipe, an SPSC ring and an MPMC ring (two senders,
+// two receivers), then measures round trips of a small message
+// bouncing between two processes.
+
+#define MEM_ID 0
+#define NSLOTS 64
+#define MAXMSG 1024
+#define NMSG 4000
+#define ROUNDTRIPS 2000
+#define PINGSIZE 16
+
+int sizes[] = {16, 64, 256, 1024};
+char buf[MAXMSG];
+struct uring *ring[2];
+
+int readn(int fd, char *p, int n)
+{
+    int got, k;
+
+    for (got = 0; got < n; got += k)
+        if ((k = read(fd, p + got, n - got)) <= 0)
+            return -1;
+    return got;
+}
+
+int pipe_stream(int size)
+{
+    int fd[2], start, i;
+
+    pipe(fd);
+    start = uptime();
+    if (fork() == 0)
+    {
+        close(fd[0]);
+        for (i = 0; i < NMSG; i++)
+            write(fd[1], buf, size);
+        exit();
+    }
+    close(fd[1]);
+    for (i = 0; i < NMSG; i++)
+        readn(fd[0], buf, size);
+    wait();
+    close(fd[0]);
+    return uptime() - start;
+}
+
+int ring_stream(int size, int flags)
+{
+    int start, i, j, nproc;
+
+    uring_init(ring[0], NSLOTS, MAXMSG, flags);
+    nproc = (flags & URING_MPMC) ? 2 : 1;
+    start = uptime();
+    for (j = 0; j < nproc; j++)
+    {
+        if (fork() == 0)
+        {
+            for (i = 0; i < NMSG / nproc; i++)
+                uring_send(ring[0], buf, size);
+            exit();
+        }
+    }
+    if (nproc > 1 && fork() == 0)
+    {
+        for (i = 0; i < NMSG / nproc; i++)
+            uring_recv(ring[0], buf, size);
+        exit();
+    }
+    for (i = 0; i < NMSG / nproc; i++)
+        uring_recv(ring[0], buf, size);
+    for (j = 0; j < 2 * nproc - 1; j++)
+        wait();
+    uring_destroy(ring[0]);
+    return uptime() - start;
+}
+
+int pipe_pingpong(void)
+{
+    int ping[2], pong[2], start, i;
+
+    pipe(ping);
+    pipe(pong);
+    start = uptime();
+    if (fork() == 0)
+    {
+        for (i = 0; i < ROUNDTRIPS; i++)
+        {
+            readn(ping[0], buf, PINGSIZE);
+            write(pong[1], buf, PINGSIZE);
+        }
+        exit();
+    }
+    for (i = 0; i < ROUNDTRIPS; i++)
+    {
+        write(ping[1], buf, PINGSIZE);
+        readn(pong[0], buf, PINGSIZE);
+    }
+    wait();
+    close(ping[0]);
+    close(ping[1]);
+    close(pong[0]);
+    close(pong[1]);
+    return uptime() - start;
+}
+
+int ring_pingpong(void)
+{
+    int start, i;
+
+    uring_init(ring[0], NSLOTS, MAXMSG, 0);
+    uring_init(ring[1], NSLOTS, MAXMSG, 0);
+    start = uptime();
+    if (fork() == 0)
+    {
+        for (i = 0; i < ROUNDTRIPS; i++)
+        {
+            uring_recv(ring[0], buf, PINGSIZE);
+            uring_send(ring[1], buf, PINGSIZE);
+        }
+        exit();
+    }
+    for (i = 0; i < ROUNDTRIPS; i++)
+    {
+        uring_send(ring[0], buf, PINGSIZE);
+        uring_recv(ring[1], buf, PINGSIZE);
+    }
+    wait();
+    uring_destroy(ring[0]);
+    uring_destroy(ring[1]);
+    return uptime() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    char *mem = 0;
+    uint bytes;
+    int i;
+
+    bytes = uring_bytes(NSLOTS, MAXMSG);
+    if (open_sharedmem(MEM_ID, 2 * bytes, &mem) < 0)
+    {
+        printf(1, "ipcbench: open_sharedmem failed\n");
+        exit();
+    }
+    ring[0] = (struct uring *)mem;
+    ring[1] = (struct uring *)(mem + bytes);
+
+    printf(1, "%d messages per size, ticks:\n", NMSG);
+    printf(1, "size\tpipe\tspsc\tmpmc\n");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+        printf(1, "%d\t%d\t%d\t%d\n", sizes[i], pipe_stream(sizes[i]),
+               ring_stream(sizes[i], 0), ring_stream(sizes[i], URING_MPMC));
+
+    printf(1, "%d round trips of %d bytes: pipe %d ticks, spsc %d ticks\n",
+           ROUNDTRIPS, PINGSIZE, pipe_pingpong(), ring_pingpong());
+
+    close_sharedmem(MEM_ID);
+    exit();
+}
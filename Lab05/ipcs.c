@@ -0,0 +1,28 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "param.h"
+#include "shm.h"
+
+// List the shared memory segments in use.
+
+int main(int argc, char *argv[])
+{
+    struct shminfo info;
+    int id, i;
+
+    printf(1, "id   name             size      resident  refs  pids\n");
+    for (id = 0; id < NSHM; id++)
+    {
+        if (shm_stat(id, &info) < 0)
+            continue;
+        printf(1, "%d\t%s\t\t%d\t%d\t%d\t", info.id, info.name[0] ? info.name : "-",
+               info.size, info.resident, info.ref_count);
+        for (i = 0; i < info.npids && i < SHMSTATPIDS; i++)
+            printf(1, " %d", info.pids[i]);
+        if (info.npids > SHMSTATPIDS)
+            printf(1, " ...");
+        printf(1, "\n");
+    }
+    exit();
+}
@@ -1,26 +1,62 @@
 // Physical memory allocator, intended to allocate
 // memory for user processes, kernel stacks, page table pages,
 // and pipe buffers. Allocates 4096-byte pages.
+//
+// lab 5: each CPU keeps a cache of up to KCACHE free pages, so
+// that most calls take only that CPU's lock.  A CPU refills its
+// cache from the global list, and drains it back, KBATCH pages at
+// a time; when both are empty it steals half of another CPU's.
+//
+// Idle CPUs also keep a pool of up to NZERO pages zeroed in
+// advance for kzalloc().  Freed pages are only filled with junk
+// in a KJUNK build (make KJUNK=1).
+//
+// NSUPERPG 4MB superpages are set aside at boot for superalloc()
+// (make NSUPERPG=n); when kalloc() runs out it breaks up a free
+// one, so the reservation costs nothing under memory pressure.
 
 #include "types.h"
 #include "defs.h"
 #include "param.h"
 #include "memlayout.h"
 #include "mmu.h"
+#include "proc.h"
 #include "spinlock.h"
+#include "memstat.h"
 
 void freerange(void *vstart, void *vend);
 extern char end[]; // first address after kernel loaded from ELF file
                    // defined by the kernel linker script in kernel.ld
 
+#define KCACHE 64  // most pages a CPU caches
+#define KBATCH 16  // pages moved at once to or from the global list
+#define NZERO 64   // pages kept zeroed for kzalloc
+
 struct run {
   struct run *next;
 };
 
+struct kcpu {
+  struct spinlock lock;
+  struct run *freelist;
+  int nfree;
+  uint nalloc;  // pages this CPU allocated, for memstat
+  uint nkfree;  // and freed
+};
+
 struct {
   struct spinlock lock;
   int use_lock;
   struct run *freelist;
+  int nfree;                   // lab 5: pages on freelist
+  int npages;                  // pages kfree'd by kinit
+  struct kcpu cpu[NCPU];       // lab 5: per-CPU caches
+  struct run *zerolist;        // lab 5: zeroed pages, allocated
+  int nzero;
+  ushort ref[PHYSTOP/PGSIZE];  // lab 5: page tables mapping each page
+  struct run *superlist;       // lab 5: free 4MB superpages
+  int nsuper;                  // superpages in the pool
+  int nsuperfree;
 } kmem;
 
 // Initialization happens in two phases.
@@ -28,10 +64,16 @@ struct {
 // the pages mapped by entrypgdir on free list.
 // 2. main() calls kinit2() with the rest of the physical pages
 // after installing a full page table that maps them on all cores.
+// lab 5: kinit2() first sets aside the top NSUPERPG 4MB-aligned
+// chunks of memory as superpages (see superalloc).
 void
 kinit1(void *vstart, void *vend)
 {
+  int i;
+
   initlock(&kmem.lock, "kmem");
+  for(i = 0; i < NCPU; i++)
+    initlock(&kmem.cpu[i].lock, "kmemcpu");
   kmem.use_lock = 0;
   freerange(vstart, vend);
 }
@@ -39,7 +81,19 @@ kinit1(void *vstart, void *vend)
 void
 kinit2(void *vstart, void *vend)
 {
-  freerange(vstart, vend);
+  struct run *r;
+  char *top;
+  int i;
+
+  top = (char*)((uint)vend & ~(SUPERPGSIZE-1));
+  for(i = 0; i < NSUPERPG && top - SUPERPGSIZE >= (char*)vstart; i++){
+    top -= SUPERPGSIZE;
+    r = (struct run*)top;
+    r->next = kmem.superlist;
+    kmem.superlist = r;
+  }
+  kmem.nsuper = kmem.nsuperfree = i;
+  freerange(vstart, top);
   kmem.use_lock = 1;
 }
 
@@ -48,32 +102,182 @@ freerange(void *vstart, void *vend)
 {
   char *p;
   p = (char*)PGROUNDUP((uint)vstart);
-  for(; p + PGSIZE <= (char*)vend; p += PGSIZE)
+  for(; p + PGSIZE <= (char*)vend; p += PGSIZE){
     kfree(p);
+    kmem.npages++;
+  }
+}
+// Atomically add d to the reference count of the page at
+// physical address pa; returns the old count.
+static ushort
+refadd(uint pa, short d)
+{
+  ushort old = d;
+
+  asm volatile("lock; xaddw %0, %1" :
+               "+r" (old), "+m" (kmem.ref[pa/PGSIZE]) :
+               :
+               "memory");
+  return old;
+}
+
+// Move up to n pages from c's cache to the global list.
+// Caller holds c->lock.
+static void
+drain(struct kcpu *c, int n)
+{
+  struct run *r;
+
+  acquire(&kmem.lock);
+  while(n-- > 0 && (r = c->freelist) != 0){
+    c->freelist = r->next;
+    c->nfree--;
+    r->next = kmem.freelist;
+    kmem.freelist = r;
+    kmem.nfree++;
+  }
+  release(&kmem.lock);
 }
+
+// Move up to n pages from the global list to c's cache.
+// Caller holds c->lock.
+static void
+refill(struct kcpu *c, int n)
+{
+  struct run *r;
+
+  acquire(&kmem.lock);
+  while(n-- > 0 && (r = kmem.freelist) != 0){
+    kmem.freelist = r->next;
+    kmem.nfree--;
+    r->next = c->freelist;
+    c->freelist = r;
+    c->nfree++;
+  }
+  release(&kmem.lock);
+}
+
+// Take half the pages cached by another CPU, keeping one
+// and giving the rest to c.  Returns 0 if every cache is empty.
+// Caller does not hold c->lock, so that two CPUs stealing from
+// each other cannot deadlock.
+static struct run*
+steal(struct kcpu *c)
+{
+  struct kcpu *o;
+  struct run *r, *last;
+  int i, n;
+
+  for(o = kmem.cpu; o < &kmem.cpu[ncpu]; o++){
+    if(o == c)
+      continue;
+    acquire(&o->lock);
+    if((r = o->freelist) == 0){
+      release(&o->lock);
+      continue;
+    }
+    n = (o->nfree + 1) / 2;
+    last = r;
+    for(i = 1; i < n; i++)
+      last = last->next;
+    o->freelist = last->next;
+    o->nfree -= n;
+    release(&o->lock);
+
+    last->next = 0;
+    if(r->next){
+      acquire(&c->lock);
+      last->next = c->freelist;
+      c->freelist = r->next;
+      c->nfree += n - 1;
+      release(&c->lock);
+    }
+    return r;
+  }
+  return 0;
+}
+
+// Give a free superpage's pages to the global list, for
+// when kalloc() has run out.  Returns 0 if there is none.
+static int
+superbreak(void)
+{
+  struct run *r, *p;
+
+  acquire(&kmem.lock);
+  if((r = kmem.superlist) != 0){
+    kmem.superlist = r->next;
+    kmem.nsuper--;
+    kmem.nsuperfree--;
+    for(p = r; (char*)p < (char*)r + SUPERPGSIZE; p = (struct run*)((char*)p + PGSIZE)){
+      p->next = kmem.freelist;
+      kmem.freelist = p;
+    }
+    kmem.nfree += SUPERPGSIZE/PGSIZE;
+    kmem.npages += SUPERPGSIZE/PGSIZE;
+  }
+  release(&kmem.lock);
+  return r != 0;
+}
+
+// Take a page from the zeroed pool; it keeps the reference
+// kzerofill() gave it.  Returns 0 if the pool is empty.
+static struct run*
+zeropop(void)
+{
+  struct run *r;
+
+  acquire(&kmem.lock);
+  if((r = kmem.zerolist) != 0){
+    kmem.zerolist = r->next;
+    kmem.nzero--;
+  }
+  release(&kmem.lock);
+  return r;
+}
+
 //PAGEBREAK: 21
 // Free the page of physical memory pointed at by v,
 // which normally should have been returned by a
 // call to kalloc().  (The exception is when
 // initializing the allocator; see kinit above.)
+// A page shared copy-on-write is freed when its
+// last reference is dropped.
 void
 kfree(char *v)
 {
   struct run *r;
+  struct kcpu *c;
 
   if((uint)v % PGSIZE || v < end || V2P(v) >= PHYSTOP)
     panic("kfree");
 
+  if(refadd(V2P(v), -1) > 1)
+    return;
+  kmem.ref[V2P(v)/PGSIZE] = 0;
+
+#ifdef KJUNK
   // Fill with junk to catch dangling refs.
   memset(v, 1, PGSIZE);
+#endif
 
-  if(kmem.use_lock)
-    acquire(&kmem.lock);
   r = (struct run*)v;
-  r->next = kmem.freelist;
-  kmem.freelist = r;
-  if(kmem.use_lock)
-    release(&kmem.lock);
+  if(!kmem.use_lock){
+    r->next = kmem.freelist;
+    kmem.freelist = r;
+    kmem.nfree++;
+    return;
+  }
+  pushcli();
+  c = &kmem.cpu[cpuid()];
+  acquire(&c->lock);
+  r->next = c->freelist;
+  c->freelist = r;
+  c->nkfree++;
+  if(++c->nfree > KCACHE)
+    drain(c, KBATCH);
+  release(&c->lock);
+  popcli();
 }
 
 // Allocate one 4096-byte page of physical memory.
@@ -83,14 +287,139 @@ char*
 kalloc(void)
 {
   struct run *r;
+  struct kcpu *c;
 
-  if(kmem.use_lock)
-    acquire(&kmem.lock);
-  r = kmem.freelist;
+  if(!kmem.use_lock){
+    if((r = kmem.freelist) != 0){
+      kmem.freelist = r->next;
+      kmem.nfree--;
+      kmem.ref[V2P(r)/PGSIZE] = 1;
+    }
+    return (char*)r;
+  }
+  pushcli();
+  c = &kmem.cpu[cpuid()];
+  acquire(&c->lock);
+  if(c->freelist == 0)
+    refill(c, KBATCH);
+  if((r = c->freelist) != 0){
+    c->freelist = r->next;
+    c->nfree--;
+  }
+  release(&c->lock);
+  if(r == 0)
+    r = steal(c);
   if(r)
-    kmem.freelist = r->next;
-  if(kmem.use_lock)
-    release(&kmem.lock);
+    c->nalloc++;
+  popcli();
+  if(r)
+    kmem.ref[V2P(r)/PGSIZE] = 1;
+  else if((r = zeropop()) == 0 && superbreak())
+    return kalloc();
+  return (char*)r;
+}
+
+// Allocate one zeroed page, from the pool of pages zeroed
+// while idle if it has any.
+char*
+kzalloc(void)
+{
+  struct run *r;
+
+  if(kmem.use_lock && (r = zeropop()) != 0){
+    r->next = 0;
+    return (char*)r;
+  }
+  if((r = (struct run*)kalloc()) != 0)
+    memset(r, 0, PGSIZE);
   return (char*)r;
 }
 
+// Zero one free page into the pool if it is short of NZERO.
+// Called by the scheduler when it has nothing to run, which
+// other CPUs start doing before kinit2() has finished.
+// Returns 1 if it zeroed a page.
+int
+kzerofill(void)
+{
+  struct run *r;
+
+  if(!kmem.use_lock || kmem.nzero >= NZERO || (r = (struct run*)kalloc()) == 0)
+    return 0;
+  memset(r, 0, PGSIZE);
+  acquire(&kmem.lock);
+  r->next = kmem.zerolist;
+  kmem.zerolist = r;
+  kmem.nzero++;
+  release(&kmem.lock);
+  return 1;
+}
+
+// Add a reference to page v, which is being shared.
+void
+kref(char *v)
+{
+  refadd(V2P(v), 1);
+}
+
+// Number of references to page v.
+int
+krefcount(char *v)
+{
+  return kmem.ref[V2P(v)/PGSIZE];
+}
+
+// lab 5: allocate one 4MB superpage, aligned to 4MB.
+// Superpages come from the pool set aside by kinit2() and are
+// never shared copy-on-write.  Returns 0 if the pool is empty.
+char*
+superalloc(void)
+{
+  struct run *r;
+
+  acquire(&kmem.lock);
+  r = kmem.superlist;
+  if(r){
+    kmem.superlist = r->next;
+    kmem.nsuperfree--;
+  }
+  release(&kmem.lock);
+  return (char*)r;
+}
+
+// Return superpage v to the pool.
+void
+superfree(char *v)
+{
+  struct run *r;
+
+  if((uint)v % SUPERPGSIZE || v < end || V2P(v) >= PHYSTOP)
+    panic("superfree");
+  r = (struct run*)v;
+  acquire(&kmem.lock);
+  r->next = kmem.superlist;
+  kmem.superlist = r;
+  kmem.nsuperfree++;
+  release(&kmem.lock);
+}
+
+// lab 5: fill in the page allocator's part of ms.
+void
+kmemstat(struct memstat *ms)
+{
+  struct kcpu *c;
+
+  acquire(&kmem.lock);
+  ms->npages = kmem.npages;
+  ms->nfree = kmem.nfree;
+  ms->nzero = kmem.nzero;
+  ms->nsuper = kmem.nsuper;
+  ms->nsuperfree = kmem.nsuperfree;
+  release(&kmem.lock);
+  ms->nalloc = ms->nkfree = 0;
+  for(c = kmem.cpu; c < &kmem.cpu[NCPU]; c++){
+    ms->nfree += c->nfree;
+    ms->nalloc += c->nalloc;
+    ms->nkfree += c->nkfree;
+  }
+}
@@ -0,0 +1,269 @@
+// Kernel semaphores, condition variables and barriers.
+//
+// User processes refer to objects by handle, an index into
+// ksync.obj.  Each object keeps its waiters in a FIFO queue
+// linked through proc.ksnext; a waker dequeues the oldest
+// waiter, marks it done and wakes it, so waiters are
+// served in arrival order and a semaphore unit handed to a
+// waiter cannot be taken by a process that arrives later.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "mmu.h"
+#include "proc.h"
+#include "spinlock.h"
+
+enum ksynctype
+{
+  KS_FREE,
+  KS_SEM,
+  KS_COND,
+  KS_BARRIER
+};
+
+struct ksyncobj
+{
+  enum ksynctype type;
+  int value;           // semaphore count, or barrier arrivals
+  int n;               // barrier parties
+  struct proc *head;   // oldest waiter
+  struct proc *tail;
+};
+
+struct
+{
+  struct spinlock lock;
+  struct ksyncobj obj[NKSYNC];
+} ksync;
+
+void ksyncinit(void)
+{
+  initlock(&ksync.lock, "ksync");
+}
+
+// Look up handle h of the given type.
+// Caller holds ksync.lock.
+static struct ksyncobj *
+getobj(int h, enum ksynctype type)
+{
+  if (h < 0 || h >= NKSYNC || ksync.obj[h].type != type)
+    return 0;
+  return &ksync.obj[h];
+}
+
+static int
+allocobj(enum ksynctype type, int value, int n)
+{
+  int h;
+
+  acquire(&ksync.lock);
+  for (h = 0; h < NKSYNC; h++)
+  {
+    if (ksync.obj[h].type == KS_FREE)
+    {
+      ksync.obj[h].type = type;
+      ksync.obj[h].value = value;
+      ksync.obj[h].n = n;
+      ksync.obj[h].head = ksync.obj[h].tail = 0;
+      release(&ksync.lock);
+      return h;
+    }
+  }
+  release(&ksync.lock);
+  return -1;
+}
+
+static void
+unlinkwaiter(struct ksyncobj *o, struct proc *w)
+{
+  struct proc *p, *prev;
+
+  prev = 0;
+  for (p = o->head; p != w; p = p->ksnext)
+    prev = p;
+  if (prev)
+    prev->ksnext = w->ksnext;
+  else
+    o->head = w->ksnext;
+  if (o->tail == w)
+    o->tail = prev;
+}
+
+// Queue the current process on o and sleep until a waker
+// dequeues it.  Returns 0, or -1 if the process was killed
+// before being dequeued.  Caller holds ksync.lock.
+static int
+waitobj(struct ksyncobj *o)
+{
+  struct proc *p = myproc();
+
+  p->ksdone = 0;
+  p->ksnext = 0;
+  if (o->tail)
+    o->tail->ksnext = p;
+  else
+    o->head = p;
+  o->tail = p;
+
+  while (!p->ksdone)
+  {
+    if (p->killed)
+    {
+      unlinkwaiter(o, p);
+      return -1;
+    }
+    sleep(&p->ksdone, &ksync.lock);
+  }
+  return 0;
+}
+
+// Dequeue and wake the oldest waiter on o.
+// Returns 0 if there was none.  Caller holds ksync.lock.
+static int
+wakeobj(struct ksyncobj *o)
+{
+  struct proc *p;
+
+  if ((p = o->head) == 0)
+    return 0;
+  if ((o->head = p->ksnext) == 0)
+    o->tail = 0;
+  p->ksdone = 1;
+  wakeup(&p->ksdone);
+  return 1;
+}
+
+int semcreate(int value)
+{
+  if (value < 0)
+    return -1;
+  return allocobj(KS_SEM, value, 0);
+}
+
+int semwait(int h)
+{
+  struct ksyncobj *o;
+  int r;
+
+  acquire(&ksync.lock);
+  if ((o = getobj(h, KS_SEM)) == 0)
+  {
+    release(&ksync.lock);
+    return -1;
+  }
+  r = 0;
+  if (o->value > 0 && o->head == 0)
+    o->value--;
+  else
+    r = waitobj(o); // sempost hands the unit over directly
+  release(&ksync.lock);
+  return r;
+}
+
+int sempost(int h)
+{
+  struct ksyncobj *o;
+
+  acquire(&ksync.lock);
+  if ((o = getobj(h, KS_SEM)) == 0)
+  {
+    release(&ksync.lock);
+    return -1;
+  }
+  if (!wakeobj(o))
+    o->value++;
+  release(&ksync.lock);
+  return 0;
+}
+
+int condcreate(void)
+{
+  return allocobj(KS_COND, 0, 0);
+}
+
+// Atomically post semaphore mutex and wait on condition h,
+// then wait on mutex again.
+int condwait(int h, int mutex)
+{
+  struct ksyncobj *o, *m;
+  int r;
+
+  acquire(&ksync.lock);
+  if ((o = getobj(h, KS_COND)) == 0 || (m = getobj(mutex, KS_SEM)) == 0)
+  {
+    release(&ksync.lock);
+    return -1;
+  }
+  if (!wakeobj(m))
+    m->value++;
+  r = waitobj(o);
+  release(&ksync.lock);
+  if (r < 0)
+    return -1;
+  return semwait(mutex);
+}
+
+// Wake the oldest waiter on condition h, or all waiters.
+int condsignal(int h, int all)
+{
+  struct ksyncobj *o;
+
+  acquire(&ksync.lock);
+  if ((o = getobj(h, KS_COND)) == 0)
+  {
+    release(&ksync.lock);
+    return -1;
+  }
+  while (wakeobj(o) && all)
+    ;
+  release(&ksync.lock);
+  return 0;
+}
+
+int barriercreate(int n)
+{
+  if (n < 1)
+    return -1;
+  return allocobj(KS_BARRIER, 0, n);
+}
+
+// Wait until n processes have called barrierwait on h.
+// The last to arrive releases the others and resets h.
+int barrierwait(int h)
+{
+  struct ksyncobj *o;
+  int r;
+
+  acquire(&ksync.lock);
+  if ((o = getobj(h, KS_BARRIER)) == 0)
+  {
+    release(&ksync.lock);
+    return -1;
+  }
+  r = 0;
+  if (++o->value == o->n)
+  {
+    o->value = 0;
+    while (wakeobj(o))
+      ;
+  }
+  else if ((r = waitobj(o)) < 0)
+    o->value--;
+  release(&ksync.lock);
+  return r;
+}
+
+// Free handle h.  Fails if processes are waiting on it.
+int ksyncfree(int h)
+{
+  acquire(&ksync.lock);
+  if (h < 0 || h >= NKSYNC || ksync.obj[h].type == KS_FREE || ksync.obj[h].head != 0)
+  {
+    release(&ksync.lock);
+    return -1;
+  }
+  ksync.obj[h].type = KS_FREE;
+  release(&ksync.lock);
+  return 0;
+}
@@ -0,0 +1,72 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "fcntl.h"
+
+// sbrk reserves address space and pages are allocated when
+// first touched: watch the resident count follow actual use.
+
+#define PAGE 4096
+#define ARENA (16 * 1024 * 1024)
+
+void report(char *what)
+{
+    int resident, reserved;
+
+    pagecount(&resident, &reserved);
+    printf(1, "%s: %d resident / %d reserved pages\n", what, resident, reserved);
+}
+
+int main(int argc, char *argv[])
+{
+    char *a, *b;
+    int i, fd;
+
+    report("start");
+    if ((a = sbrk(ARENA)) == (char *)-1)
+    {
+        printf(1, "lazytest: sbrk failed\n");
+        exit();
+    }
+    report("after sbrk 16MB");
+
+    for (i = 0; i < ARENA; i += 16 * PAGE)
+        if (a[i] != 0)
+        {
+            printf(1, "lazytest: page not zeroed\n");
+            exit();
+        }
+    for (i = 0; i < ARENA; i += 16 * PAGE)
+        a[i] = 1;
+    report("after touching every 16th page");
+
+    // The kernel stores into an untouched page.
+    b = a + ARENA - PAGE;
+    if ((fd = open("README", O_RDONLY)) >= 0)
+    {
+        if (read(fd, b, 64) != 64)
+            printf(1, "lazytest: read into untouched page failed\n");
+        close(fd);
+    }
+
+    if (fork() == 0)
+    {
+        report("child");
+        for (i = 0; i < ARENA; i += 16 * PAGE)
+            if (a[i] != 1)
+            {
+                printf(1, "lazytest: child sees wrong data\n");
+                exit();
+            }
+        a[PAGE] = 2; // never touched by the parent
+        exit();
+    }
+    wait();
+    if (a[PAGE] != 0)
+        printf(1, "lazytest: child write leaked into parent\n");
+
+    sbrk(-ARENA);
+    report("after sbrk -16MB");
+    printf(1, "lazytest ok\n");
+    exit();
+}
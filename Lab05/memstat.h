@@ -0,0 +1,53 @@
+// lab 5
+// Memory statistics (memstat), printed by vmstat.
+// Counts are in 4KB pages unless noted.
+
+#define MSSLABS 16 // caches reported
+#define MSPROCS 64 // processes reported
+
+// Page faults by how they were resolved.
+#define PF_COW  0 // write to a page shared by fork
+#define PF_TEXT 1 // program text and data, loaded by exec
+#define PF_HEAP 2 // first touch of a heap page
+#define PF_SHM  3 // shared memory
+#define PF_MMAP 4 // file mapping
+#define PF_BAD  5 // none of the above: the process is killed
+#define NPF     6
+
+struct slabstat
+{
+  char name[16];
+  uint size;   // object size in bytes
+  uint nslab;  // pages held
+  uint inuse;  // objects allocated
+  uint nalloc; // allocations since boot
+};
+
+struct procstat
+{
+  int pid;
+  char name[16];
+  uint resident; // user pages with a frame
+  uint reserved; // pages of address space in its areas
+  uint pgtables; // user page table pages
+};
+
+struct memstat
+{
+  uint npages;      // pages managed by kalloc
+  uint nfree;       // on the free lists
+  uint nzero;       // kept zeroed for kzalloc
+  uint nsuper;      // 4MB superpages in the pool
+  uint nsuperfree;
+  uint nalloc;      // pages allocated since boot
+  uint nkfree;      // pages freed since boot
+  uint faults[NPF]; // page faults since boot
+  uint nshm;        // shared memory segments in use
+  uint shmpages;    // their pages with a frame
+  uint pcachepages; // page cache entries holding a page
+  uint kstacks;     // kernel stacks
+  int nslab;
+  struct slabstat slab[MSSLABS];
+  int nproc;
+  struct procstat proc[MSPROCS];
+};
@@ -0,0 +1,10 @@
+// lab 5
+// File mappings (mmap, munmap).
+
+#define PROT_READ   0x1
+#define PROT_WRITE  0x2
+
+#define MAP_SHARED  0x1 // stores reach the file and other mappings
+#define MAP_PRIVATE 0x2 // stores stay in this process
+
+#define MAP_FAILED ((void *)-1)
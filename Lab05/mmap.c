@@ -0,0 +1,518 @@
+// lab 5
+// File mappings and the page cache behind them.
+//
+// pcache holds file pages keyed by (dev, inum, offset, length):
+// a page holds length bytes of the file from offset, then zeros.
+// A MAP_SHARED mapping maps the cached page itself, so processes
+// mapping the same part of a file share its memory, and a page
+// that was stored to is written to the file when it is unmapped.
+// A MAP_PRIVATE mapping maps the cached page read-only and copies
+// it on the first write.  Pages are loaded on the first fault.
+//
+// Only shared mappings hold cache entries, which they need to
+// stay coherent and to be written back.  A private mapping holds
+// its page through a kalloc reference instead, so the entry can
+// be reused as soon as the fault is over; a process mapping a
+// file larger than the cache does not run out of entries.
+//
+// Program text is cached the same way (see execfault), so every
+// process running a binary shares one copy of its pages.  Text
+// pages are mapped copy-on-write and hold a kalloc reference per
+// mapping; writing the file detaches them from the cache rather
+// than changing the pages under running programs.
+//
+// Locking follows the buffer cache: pcache.lock protects the
+// table and reference counts, and each page's sleeplock
+// serializes loading and writing back its contents.  A page's
+// sleeplock is taken before the inode lock.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "x86.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "sleeplock.h"
+#include "stat.h"
+#include "fs.h"
+#include "file.h"
+#include "mman.h"
+
+struct pcpage
+{
+  struct sleeplock lock;
+  uint dev;
+  uint inum;     // 0 if the entry holds no file page
+  uint off;      // file offset of the page
+  uint len;      // bytes from the file; the rest is zero
+  int text;      // program text, mapped by execfault
+  int valid;     // mem holds the file's data
+  int ref;       // shared mappings, plus callers of pcacheget
+  uint lastuse;
+  char *mem;
+};
+
+struct
+{
+  struct spinlock lock;
+  struct pcpage page[NPCACHE];
+  uint clock;
+} pcache;
+
+void pcacheinit(void)
+{
+  struct pcpage *pg;
+
+  initlock(&pcache.lock, "pcache");
+  for (pg = pcache.page; pg < &pcache.page[NPCACHE]; pg++)
+    initsleeplock(&pg->lock, "pcpage");
+}
+
+// Give up the cache's claim on pg's page.  If text mappings
+// still hold the page, leave it to them and take a fresh one.
+// Caller holds pcache.lock; pg is idle.
+static void
+detach(struct pcpage *pg)
+{
+  pg->inum = 0;
+  pg->valid = 0;
+  if (pg->mem && krefcount(pg->mem) > 1)
+  {
+    kfree(pg->mem);
+    pg->mem = 0;
+  }
+}
+
+// Return the page holding len bytes of ip from off, with its
+// data loaded and a reference held, reusing the least recently
+// used idle page if it is not cached.  Returns 0 if off lies
+// past the end of the file, a text page is short, or every
+// cache entry is in use.
+static struct pcpage *
+pcacheget(struct inode *ip, uint off, uint len, int text)
+{
+  struct pcpage *pg, *victim;
+  int n;
+
+  acquire(&pcache.lock);
+  victim = 0;
+  for (pg = pcache.page; pg < &pcache.page[NPCACHE]; pg++)
+  {
+    if (pg->inum == ip->inum && pg->dev == ip->dev && pg->off == off && pg->len == len && pg->text == text)
+      goto found;
+    if (pg->ref == 0 && (victim == 0 || pg->lastuse < victim->lastuse))
+      victim = pg;
+  }
+  if ((pg = victim) == 0)
+  {
+    release(&pcache.lock);
+    return 0;
+  }
+  detach(pg);
+  if (pg->mem == 0 && (pg->mem = kalloc()) == 0)
+  {
+    release(&pcache.lock);
+    return 0;
+  }
+  pg->dev = ip->dev;
+  pg->inum = ip->inum;
+  pg->off = off;
+  pg->len = len;
+  pg->text = text;
+
+found:
+  pg->ref++;
+  pg->lastuse = ++pcache.clock;
+  release(&pcache.lock);
+
+  acquiresleep(&pg->lock);
+  if (!pg->valid)
+  {
+    ilock(ip);
+    if (off < ip->size)
+    {
+      memset(pg->mem, 0, PGSIZE);
+      n = readi(ip, pg->mem, off, len);
+      pg->valid = text ? n == len : n > 0;
+    }
+    iunlock(ip);
+  }
+  if (!pg->valid)
+  {
+    releasesleep(&pg->lock);
+    acquire(&pcache.lock);
+    pg->ref--;
+    release(&pcache.lock);
+    return 0;
+  }
+  releasesleep(&pg->lock);
+  return pg;
+}
+
+// Find the cache entry whose page is mapped at mem.
+// Caller holds pcache.lock.
+static struct pcpage *
+pcachefind(char *mem)
+{
+  struct pcpage *pg;
+
+  for (pg = pcache.page; pg < &pcache.page[NPCACHE]; pg++)
+    if (pg->mem == mem && pg->ref > 0)
+      return pg;
+  panic("pcachefind");
+}
+
+static void
+pcacheput(char *mem)
+{
+  acquire(&pcache.lock);
+  pcachefind(mem)->ref--;
+  release(&pcache.lock);
+}
+
+static void
+pcachedup(char *mem)
+{
+  acquire(&pcache.lock);
+  pcachefind(mem)->ref++;
+  release(&pcache.lock);
+}
+
+// Number of entries holding a page.
+int pcachecount(void)
+{
+  struct pcpage *pg;
+  int n;
+
+  n = 0;
+  acquire(&pcache.lock);
+  for (pg = pcache.page; pg < &pcache.page[NPCACHE]; pg++)
+    if (pg->mem)
+      n++;
+  release(&pcache.lock);
+  return n;
+}
+
+// Return the cached page holding len bytes of program ip from
+// off, with a kalloc reference taken for the caller's mapping;
+// it is released by kfree like any other user page.
+char *pcachetext(struct inode *ip, uint off, uint len)
+{
+  struct pcpage *pg;
+  char *mem;
+
+  if ((pg = pcacheget(ip, off, len, 1)) == 0)
+    return 0;
+  mem = pg->mem;
+  kref(mem);
+  pcacheput(mem);
+  return mem;
+}
+
+// Write the part of page pg inside the file back to ip, a few
+// blocks per transaction as in filewrite.
+static void
+writeback(struct inode *ip, struct pcpage *pg)
+{
+  int max = ((MAXOPBLOCKS - 1 - 1 - 2) / 2) * BSIZE;
+  uint off, n, i, n1;
+
+  acquiresleep(&pg->lock);
+  off = pg->off;
+  ilock(ip);
+  n = ip->size > off ? ip->size - off : 0;
+  iunlock(ip);
+  if (n > PGSIZE)
+    n = PGSIZE;
+  for (i = 0; i < n; i += n1)
+  {
+    n1 = n - i < max ? n - i : max;
+    begin_op();
+    ilock(ip);
+    writei(ip, pg->mem + i, off + i, n1);
+    iunlock(ip);
+    end_op();
+  }
+  releasesleep(&pg->lock);
+}
+
+// Bring cached pages of ip up to date after write() changed
+// bytes [off, off+n) of the file.  Idle text pages are detached
+// instead: programs already running keep the old contents.
+void pcachesync(struct inode *ip, uint off, uint n)
+{
+  struct pcpage *pg;
+  uint start, end;
+
+  acquire(&pcache.lock);
+  for (pg = pcache.page; pg < &pcache.page[NPCACHE]; pg++)
+  {
+    start = pg->off;
+    end = start + pg->len;
+    if (pg->inum != ip->inum || pg->dev != ip->dev || !pg->valid || end <= off || start >= off + n)
+      continue;
+    if (pg->text && pg->ref == 0)
+    {
+      detach(pg);
+      continue;
+    }
+    if (start < off)
+      start = off;
+    if (end > off + n)
+      end = off + n;
+    pg->ref++;
+    release(&pcache.lock);
+    acquiresleep(&pg->lock);
+    ilock(ip);
+    readi(ip, pg->mem + (start - pg->off), start, end - start);
+    iunlock(ip);
+    releasesleep(&pg->lock);
+    acquire(&pcache.lock);
+    pg->ref--;
+  }
+  release(&pcache.lock);
+}
+
+// Forget the cached pages of ip, whose inode is being freed.
+// Nothing maps them: a mapping holds a reference to the file.
+void pcachedrop(struct inode *ip)
+{
+  struct pcpage *pg;
+
+  acquire(&pcache.lock);
+  for (pg = pcache.page; pg < &pcache.page[NPCACHE]; pg++)
+  {
+    if (pg->inum == ip->inum && pg->dev == ip->dev && pg->ref == 0)
+      detach(pg);
+  }
+  release(&pcache.lock);
+}
+
+// Map length bytes of f starting at off into the current
+// process, at addr if it is not 0.  Returns the address, or -1.
+int mmap_file(struct file *f, uint addr, int length, int prot, int flags, int off)
+{
+  struct proc *curproc = myproc();
+  struct vma *v;
+  uint size;
+  int type;
+
+  if (length <= 0 || off < 0 || off % PGSIZE != 0 || addr % PGSIZE != 0)
+    return -1;
+  if (flags != MAP_SHARED && flags != MAP_PRIVATE)
+    return -1;
+  if (f->type != FD_INODE || !f->readable)
+    return -1;
+  if ((flags & MAP_SHARED) && (prot & PROT_WRITE) && !f->writable)
+    return -1;
+  ilock(f->ip);
+  type = f->ip->type;
+  iunlock(f->ip);
+  if (type != T_FILE)
+    return -1;
+
+  size = PGROUNDUP(length);
+  if (addr)
+    v = vmaadd(curproc, VMA_MMAP, addr, addr + size);
+  else
+    v = vmaplace(curproc, VMA_MMAP, size, PGSIZE);
+  if (v == 0)
+    return -1;
+  v->file = filedup(f);
+  v->off = off;
+  v->prot = prot;
+  v->flags = flags;
+  return v->start;
+}
+
+// Unmap area v of p, writing back the shared pages p stored to.
+static void
+unmap_file(struct proc *p, struct vma *v)
+{
+  struct pcpage *pg;
+  pte_t *pte;
+  char *mem;
+  uint a;
+
+  for (a = v->start; a < v->end; a += PGSIZE)
+  {
+    if ((pte = walkpgdir(p->pgdir, (char *)a, 0)) == 0 || !(*pte & PTE_P))
+      continue;
+    mem = P2V(PTE_ADDR(*pte));
+    if (v->flags & MAP_PRIVATE)
+      kfree(mem);
+    else
+    {
+      if (*pte & PTE_D)
+      {
+        acquire(&pcache.lock);
+        pg = pcachefind(mem);
+        release(&pcache.lock);
+        writeback(v->file->ip, pg);
+      }
+      pcacheput(mem);
+    }
+    *pte = 0;
+  }
+  if (p == myproc())
+    lcr3(V2P(p->pgdir));
+  fileclose(v->file);
+  vmafree(v);
+}
+
+// Unmap the whole mapping at addr; partial unmaps are not
+// supported.
+int munmap_file(uint addr, int length)
+{
+  struct proc *curproc = myproc();
+  struct vma *v;
+
+  if ((v = vmafind(curproc, addr)) == 0 || v->type != VMA_MMAP)
+    return -1;
+  if (addr != v->start || PGROUNDUP(length) != v->end - v->start)
+    return -1;
+  unmap_file(curproc, v);
+  return 0;
+}
+
+// Unmap every file mapping of p, before its page table is
+// freed (exit, exec, a failed fork).
+void close_all_mmap(struct proc *p)
+{
+  struct vma *v;
+
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+    if (v->type == VMA_MMAP)
+      unmap_file(p, v);
+}
+
+// Give child np parent's file mappings: shared pages and
+// untouched private pages are shared with the parent, private
+// copies are copied.  Returns -1 if out of memory; the caller
+// then undoes the partial work with close_all_mmap(np).
+int fork_mmap(struct proc *np, struct proc *parent)
+{
+  struct vma *v, *nv;
+  pte_t *pte;
+  char *mem;
+  uint a;
+
+  for (v = parent->vma; v < &parent->vma[NVMA]; v++)
+  {
+    if (v->type != VMA_MMAP)
+      continue;
+    nv = &np->vma[v - parent->vma];
+    *nv = *v;
+    filedup(nv->file);
+    for (a = v->start; a < v->end; a += PGSIZE)
+    {
+      if ((pte = walkpgdir(parent->pgdir, (char *)a, 0)) == 0 || !(*pte & PTE_P))
+        continue;
+      mem = P2V(PTE_ADDR(*pte));
+      if ((v->flags & MAP_SHARED) || !(*pte & PTE_W))
+      {
+        if (v->flags & MAP_SHARED)
+          pcachedup(mem);
+        else
+          kref(mem);
+        if (mappages(np->pgdir, (char *)a, PGSIZE, PTE_ADDR(*pte), *pte & (PTE_W | PTE_U)) < 0)
+        {
+          if (v->flags & MAP_SHARED)
+            pcacheput(mem);
+          else
+            kfree(mem);
+          return -1;
+        }
+        continue;
+      }
+      if ((mem = kalloc()) == 0)
+        return -1;
+      memmove(mem, P2V(PTE_ADDR(*pte)), PGSIZE);
+      if (mappages(np->pgdir, (char *)a, PGSIZE, V2P(mem), PTE_W | PTE_U) < 0)
+      {
+        kfree(mem);
+        return -1;
+      }
+    }
+  }
+  return 0;
+}
+
+// Page fault at va in the current process, with error code err.
+// If va lies in a file mapping, map the file's page, or copy it
+// on a write to a private mapping.  Returns -1 if va is not
+// mapped, the access is not allowed, or the page is past the
+// end of the file.
+int mmap_fault(uint va, uint err)
+{
+  struct proc *curproc = myproc();
+  struct pcpage *pg;
+  struct vma *v;
+  pte_t *pte;
+  char *mem, *old;
+  int perm;
+
+  if ((v = vmafind(curproc, va)) == 0 || v->type != VMA_MMAP)
+    return -1;
+  if ((err & FEC_WR) && !(v->prot & PROT_WRITE))
+    return -1;
+  va = PGROUNDDOWN(va);
+
+  if ((pte = walkpgdir(curproc->pgdir, (char *)va, 0)) != 0 && (*pte & PTE_P))
+  {
+    // Present: only a write to an uncopied private page is legal.
+    if (!(err & FEC_WR) || (*pte & PTE_W) || (v->flags & MAP_SHARED))
+      return -1;
+    // The page is ours alone once the cache has let it go.
+    old = P2V(PTE_ADDR(*pte));
+    if (krefcount(old) == 1)
+      mem = old;
+    else
+    {
+      if ((mem = kalloc()) == 0)
+        return -1;
+      memmove(mem, old, PGSIZE);
+      kfree(old);
+    }
+    *pte = V2P(mem) | PTE_P | PTE_W | PTE_U;
+    lcr3(V2P(curproc->pgdir));
+    return 0;
+  }
+
+  if ((pg = pcacheget(v->file->ip, v->off + va - v->start, PGSIZE, 0)) == 0)
+    return -1;
+  perm = PTE_U;
+  if (v->flags & MAP_SHARED)
+  {
+    if (v->prot & PROT_WRITE)
+      perm |= PTE_W;
+    if (mappages(curproc->pgdir, (char *)va, PGSIZE, V2P(pg->mem), perm) < 0)
+    {
+      pcacheput(pg->mem);
+      return -1;
+    }
+    return 0;
+  }
+
+  // Private: copy the page on a write, else take a kalloc
+  // reference to it; either way the cache entry is let go.
+  mem = 0;
+  if (!(err & FEC_WR))
+    kref(mem = pg->mem);
+  else if ((mem = kalloc()) != 0)
+  {
+    memmove(mem, pg->mem, PGSIZE);
+    perm |= PTE_W;
+  }
+  pcacheput(pg->mem);
+  if (mem == 0)
+    return -1;
+  if (mappages(curproc->pgdir, (char *)va, PGSIZE, V2P(mem), perm) < 0)
+  {
+    kfree(mem);
+    return -1;
+  }
+  return 0;
+}
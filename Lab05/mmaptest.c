@@ -0,0 +1,181 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "fcntl.h"
+#include "mman.h"
+
+// Checks private and shared file mappings, their inheritance
+// across fork and coherence with write(), then times scanning a
+// file with read() against scanning a mapping of it.
+
+#define FILE "mmapfile"
+#define SIZE (3 * 4096 + 100)
+#define SCANS 50
+
+char buf[512];
+
+void fail(char *msg)
+{
+    printf(1, "mmaptest: %s FAILED\n", msg);
+    unlink(FILE);
+    exit();
+}
+
+char expect(int i)
+{
+    return 'a' + i % 23;
+}
+
+void makefile(void)
+{
+    int fd, i, j;
+
+    if ((fd = open(FILE, O_CREATE | O_RDWR)) < 0)
+        fail("create");
+    for (i = 0; i < SIZE; i += sizeof(buf))
+    {
+        for (j = 0; j < sizeof(buf); j++)
+            buf[j] = expect(i + j);
+        write(fd, buf, SIZE - i < sizeof(buf) ? SIZE - i : sizeof(buf));
+    }
+    close(fd);
+}
+
+// Byte off of the file, read with read().
+char fileat(int off)
+{
+    int fd;
+    char c;
+
+    fd = open(FILE, O_RDONLY);
+    while (off >= sizeof(buf))
+    {
+        read(fd, buf, sizeof(buf));
+        off -= sizeof(buf);
+    }
+    read(fd, buf, off + 1);
+    c = buf[off];
+    close(fd);
+    return c;
+}
+
+void test_private(void)
+{
+    int fd, i;
+    char *p;
+
+    fd = open(FILE, O_RDONLY);
+    if ((p = mmap(0, SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)) == MAP_FAILED)
+        fail("private mmap");
+    close(fd);
+    for (i = 0; i < SIZE; i++)
+        if (p[i] != expect(i))
+            fail("private contents");
+    if (p[SIZE] != 0)
+        fail("zeroed tail");
+    p[0] = 'X';
+    p[4096] = 'Y';
+    if (munmap(p, SIZE) < 0)
+        fail("private munmap");
+    if (fileat(0) != expect(0) || fileat(4096) != expect(4096))
+        fail("private store reached the file");
+    printf(1, "private mapping ok\n");
+}
+
+void test_shared(void)
+{
+    int fd;
+    char *p;
+
+    fd = open(FILE, O_RDWR);
+    if ((p = mmap(0, SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+        fail("shared mmap");
+
+    // A child inherits the mapping and shares its pages.
+    if (fork() == 0)
+    {
+        p[1] = 'C';
+        exit();
+    }
+    wait();
+    if (p[1] != 'C')
+        fail("fork sharing");
+
+    // write() shows up in the mapping.
+    read(fd, buf, 2);
+    write(fd, "W", 1);
+    if (p[2] != 'W')
+        fail("write coherence");
+
+    p[8192] = 'S';
+    close(fd);
+    if (munmap(p, SIZE) < 0)
+        fail("shared munmap");
+    if (fileat(1) != 'C' || fileat(2) != 'W' || fileat(8192) != 'S')
+        fail("write back");
+    printf(1, "shared mapping ok\n");
+}
+
+void test_beyond_eof(void)
+{
+    int fd, pid;
+    char *p;
+
+    fd = open(FILE, O_RDONLY);
+    p = mmap(0, SIZE + 4096, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        fail("long mmap");
+    if ((pid = fork()) == 0)
+    {
+        printf(1, "read past end of file: %d\n", p[SIZE + 4096 - 1]);
+        exit();
+    }
+    wait();
+    munmap(p, SIZE + 4096);
+    printf(1, "fault past end of file ok (expect a trap message above)\n");
+}
+
+void bench(void)
+{
+    int fd, i, j, n, sum, start, t_read, t_mmap;
+    char *p;
+
+    sum = 0;
+    start = uptime();
+    for (i = 0; i < SCANS; i++)
+    {
+        fd = open(FILE, O_RDONLY);
+        while ((n = read(fd, buf, sizeof(buf))) > 0)
+            for (j = 0; j < n; j++)
+                sum += buf[j];
+        close(fd);
+    }
+    t_read = uptime() - start;
+
+    start = uptime();
+    for (i = 0; i < SCANS; i++)
+    {
+        fd = open(FILE, O_RDONLY);
+        p = mmap(0, SIZE, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        for (j = 0; j < SIZE; j++)
+            sum -= p[j];
+        munmap(p, SIZE);
+    }
+    t_mmap = uptime() - start;
+
+    printf(1, "%d scans of %d bytes: read %d ticks, mmap %d ticks%s\n",
+           SCANS, SIZE, t_read, t_mmap, sum == 0 ? "" : " (MISMATCH)");
+}
+
+int main(int argc, char *argv[])
+{
+    makefile();
+    test_private();
+    test_shared();
+    test_beyond_eof();
+    bench();
+    unlink(FILE);
+    exit();
+}
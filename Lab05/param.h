@@ -2,13 +2,20 @@
 #define KSTACKSIZE 4096  // size of per-process kernel stack
 #define NCPU          8  // maximum number of CPUs
 #define NOFILE       16  // open files per process
-#define NFILE       100  // open files per system
-#define NINODE       50  // maximum number of active i-nodes
+#define NINODE       50  // unreferenced i-nodes kept cached
 #define NDEV         10  // maximum major device number
 #define ROOTDEV       1  // device number of file system root disk
 #define MAXARG       32  // max exec arguments
 #define MAXOPBLOCKS  10  // max # of blocks any FS op writes
 #define LOGSIZE      (MAXOPBLOCKS*3)  // max data blocks in on-disk log
 #define NBUF         (MAXOPBLOCKS*3)  // size of disk block cache
-#define FSSIZE       1000  // size of file system in blocks
+#define NKSYNC       32  // semaphores, condition variables and barriers
+#define MAX_SHARED_MEM 10  // numbered shared memory segments
+#define NSHM         64  // shared memory segments, numbered and named
+#define NVMA         16  // memory areas per process
+#define NPCACHE      128  // file pages cached for mmap and exec
+#ifndef NSUPERPG
+#define NSUPERPG     1  // 4MB superpages set aside for user memory
+#endif
+#define FSSIZE       2000  // size of file system in blocks
 
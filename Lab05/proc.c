@@ -7,6 +7,8 @@
 #include "proc.h"
 #include "spinlock.h"
 #include "sleeplock.h"
+#include "shm.h"
+#include "memstat.h"
 
 struct
 {
@@ -115,7 +117,7 @@ found:
   p->context = (struct context *)sp;
   memset(p->context, 0, sizeof *p->context);
   p->context->eip = (uint)forkret;
-  p->top = 0xA0000; // lab 5
+  vmainit(p); // lab 5
   return p;
 }
 
@@ -133,6 +135,8 @@ void userinit(void)
     panic("userinit: out of memory?");
   inituvm(p->pgdir, _binary_initcode_start, (int)_binary_initcode_size);
   p->sz = PGSIZE;
+  vmaadd(p, VMA_TEXT, 0, PGSIZE);
+  vmaadd(p, VMA_HEAP, PGSIZE, PGSIZE);
   memset(p->tf, 0, sizeof(*p->tf));
   p->tf->cs = (SEG_UCODE << 3) | DPL_USER;
   p->tf->ds = (SEG_UDATA << 3) | DPL_USER;
@@ -158,27 +162,71 @@ void userinit(void)
 
 // Grow current process's memory by n bytes.
 // Return 0 on success, -1 on failure.
+// lab 5: growing only reserves the addresses; heapfault()
+// allocates each page when it is first touched.
 int growproc(int n)
 {
   uint sz;
   struct proc *curproc = myproc();
 
+  struct vma *heap = vmaget(curproc, VMA_HEAP);
+
   sz = curproc->sz;
   if (n > 0)
   {
-    if ((sz = allocuvm(curproc->pgdir, sz, sz + n)) == 0)
+    if (sz + n < sz || sz + n > SHMTOP || vmaoverlaps(curproc, sz, sz + n)) // lab 5
       return -1;
+    sz += n;
   }
   else if (n < 0)
   {
+    if (sz + n < heap->start) // lab 5: the heap only
+      return -1;
     if ((sz = deallocuvm(curproc->pgdir, sz, sz + n)) == 0)
       return -1;
   }
   curproc->sz = sz;
+  heap->end = sz;
   switchuvm(curproc);
   return 0;
 }
 
+// lab 5: page fault at va in the current process.  If va lies
+// in the heap, give its page a zeroed frame.  Returns -1 if va
+// is not in the heap, is already mapped, or memory is exhausted.
+// With curproc->superpages set, a fault in a 4MB-aligned stretch
+// of heap that has no pages yet maps a whole superpage, if the
+// pool has one.
+int heapfault(uint va)
+{
+  struct proc *curproc = myproc();
+  struct vma *v;
+  pte_t *pte;
+  char *mem;
+  uint base;
+
+  if ((v = vmafind(curproc, va)) == 0 || v->type != VMA_HEAP)
+    return -1;
+  base = va & ~(SUPERPGSIZE - 1);
+  if (curproc->superpages && base >= v->start && base + SUPERPGSIZE <= v->end &&
+      !(curproc->pgdir[PDX(va)] & PTE_P) && (mem = superalloc()) != 0)
+  {
+    memset(mem, 0, SUPERPGSIZE);
+    return mapsuper(curproc->pgdir, base, V2P(mem), PTE_W | PTE_U);
+  }
+  va = PGROUNDDOWN(va);
+  if ((pte = walkpgdir(curproc->pgdir, (char *)va, 0)) != 0 && (*pte & PTE_P))
+    return -1;
+  if ((mem = kzalloc()) == 0)
+    return -1;
+  if (mappages(curproc->pgdir, (char *)va, PGSIZE, V2P(mem), PTE_W | PTE_U) < 0)
+  {
+    kfree(mem);
+    return -1;
+  }
+  return 0;
+}
+
 // Create a new process copying p as the parent.
 // Sets up stack to return as if from system call.
 // Caller must set state of returned proc to RUNNABLE.
@@ -204,6 +252,25 @@ int fork(void)
   }
   np->sz = curproc->sz;
   np->parent = curproc;
+  np->superpages = curproc->superpages;
+  // lab 5: shared memory is shared with the child, not copied,
+  // and file mappings share the page cache.
+  for (i = 0; i < NVMA; i++)
+    if (curproc->vma[i].type != VMA_SHM && curproc->vma[i].type != VMA_MMAP)
+      if ((np->vma[i] = curproc->vma[i]).ip)
+        idup(np->vma[i].ip);
+  if (fork_sharedmem(np, curproc) < 0 || fork_mmap(np, curproc) < 0)
+  {
+    close_all_sharedmem(np);
+    close_all_mmap(np);
+    vmaiput(np);
+    freevm(np->pgdir);
+    np->pgdir = 0;
+    kfree(np->kstack);
+    np->kstack = 0;
+    np->state = UNUSED;
+    return -1;
+  }
   *np->tf = *curproc->tf;
 
   // Clear %eax so that fork returns 0 in the child.
@@ -239,6 +306,9 @@ void exit(void)
   if (curproc == initproc)
     panic("init exiting");
 
+  close_all_sharedmem(curproc); // lab 5
+  close_all_mmap(curproc);
+
   // Close all open files.
   for (fd = 0; fd < NOFILE; fd++)
   {
@@ -249,6 +319,7 @@ void exit(void)
     }
   }
 
+  vmaiput(curproc); // lab 5
   begin_op();
   iput(curproc->cwd);
   end_op();
@@ -335,6 +406,7 @@ void scheduler(void)
 {
   struct proc *p;
   struct cpu *c = mycpu();
+  int ran;
   c->proc = 0;
 
   for (;;)
@@ -343,11 +415,13 @@ void scheduler(void)
     sti();
 
     // Loop over process table looking for process to run.
+    ran = 0;
     acquire(&ptable.lock);
     for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
     {
       if (p->state != RUNNABLE)
         continue;
+      ran = 1;
 
       // Switch to chosen process.  It is the process's job
       // to release ptable.lock and then reacquire it
@@ -364,6 +438,10 @@ void scheduler(void)
       c->proc = 0;
     }
     release(&ptable.lock);
+
+    // lab 5: nothing to run; zero a page for kzalloc.
+    if (!ran)
+      kzerofill();
   }
 }
 
@@ -534,6 +612,8 @@ void procdump(void)
     else
       state = "???";
     cprintf("%d %s %s", p->pid, state, p->name);
+    if (p->pgdir) // lab 5: resident/reserved pages
+      cprintf(" %d/%d", uvmresident(p->pgdir), vmareserved(p));
     if (p->state == SLEEPING)
     {
       getcallerpcs((uint *)p->context->ebp + 2, pc);
@@ -542,119 +622,471 @@ void procdump(void)
     }
     cprintf("\n");
   }
+  slabdump(); // lab 5
+}
+
+// lab 5: fill in ms's per-process memory use and kernel stack
+// count.  A process may exec or exit meanwhile, so the counts
+// are a snapshot, not exact.
+void procmemstat(struct memstat *ms)
+{
+  struct proc *p;
+  struct procstat *ps;
+
+  ms->nproc = 0;
+  ms->kstacks = 0;
+  acquire(&ptable.lock);
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  {
+    if (p->kstack)
+      ms->kstacks++;
+    if (p->state == UNUSED || p->state == EMBRYO || p->pgdir == 0 || ms->nproc == MSPROCS)
+      continue;
+    ps = &ms->proc[ms->nproc++];
+    ps->pid = p->pid;
+    safestrcpy(ps->name, p->name, sizeof(ps->name));
+    ps->resident = uvmresident(p->pgdir);
+    ps->reserved = vmareserved(p);
+    ps->pgtables = uvmpgtables(p->pgdir);
+  }
+  release(&ptable.lock);
 }
 // lab 5
-#define MAX_SHARED_MEM 10
+// A segment's pages are allocated when a process first touches
+// them (see sharedmem_fault); pages[i] holds the physical
+// address of page i, or 0 if no process has touched it yet.
+//
+// Ids below MAX_SHARED_MEM are numbered segments that programs
+// open by id.  The rest of the table holds named segments
+// (shm_open), found by name through shmhash and given an id
+// when created; a named segment and its name live until the
+// last process closes it.
+//
+// A huge segment (SHM_HUGE) is made of 4MB superpages instead,
+// mapped at 4MB-aligned addresses; pages[i] then holds
+// superpage i.
+#define SHM_MAXPAGES (PGSIZE / sizeof(uint))
+#define SHMHASH 31
+#define SHMPGSIZE(shm) ((shm)->huge ? SUPERPGSIZE : PGSIZE)
 
 struct shared_memory
 {
   int id;
   int ref_count;
   struct sleeplock lock;
-  uint physical_memory;
+  uint size;   // bytes, a multiple of SHMPGSIZE
+  uint *pages; // physical page addresses, from kmalloc
+  int huge;    // made of superpages
+  char name[SHMNAMESZ];        // empty for a numbered segment
+  struct shared_memory *next;  // hash chain
 };
 
-struct shared_memory shared_memory_table[MAX_SHARED_MEM];
+struct shared_memory shared_memory_table[NSHM];
+struct shared_memory *shmhash[SHMHASH];
+struct spinlock shmlock; // protects the table, but not the sleeplocks
+
+void init_shared_memory_table(void)
+{
+  initlock(&shmlock, "shared_memory_table");
+  for (int i = 0; i < NSHM; i++)
+  {
+    shared_memory_table[i].id = i;
+    shared_memory_table[i].ref_count = 0;
+    shared_memory_table[i].size = 0;
+    shared_memory_table[i].pages = 0;
+    shared_memory_table[i].huge = 0;
+    shared_memory_table[i].name[0] = 0;
+    initsleeplock(&shared_memory_table[i].lock, "shared_memory_table");
+  }
+}
+
+static uint
+shmhashname(char *name)
+{
+  uint h = 0;
+
+  while (*name)
+    h = h * 31 + (uchar)*name++;
+  return h % SHMHASH;
+}
+
+// Caller holds shmlock.
+static struct shared_memory *
+lookup_sharedmem(char *name)
+{
+  struct shared_memory *shm;
 
-int is_init = 0;
+  for (shm = shmhash[shmhashname(name)]; shm != 0; shm = shm->next)
+    if (strncmp(shm->name, name, SHMNAMESZ) == 0)
+      return shm;
+  return 0;
+}
+
+// Caller holds shmlock.
+static void
+unname_sharedmem(struct shared_memory *shm)
+{
+  struct shared_memory **pp;
+
+  for (pp = &shmhash[shmhashname(shm->name)]; *pp != shm; pp = &(*pp)->next)
+    ;
+  *pp = shm->next;
+  shm->name[0] = 0;
+}
 
-void init_shared_memory_table() // is called to make sure the array(table) is init
+// Map page i of segment shm at va in pgdir.
+static int
+mapshmpage(pde_t *pgdir, struct shared_memory *shm, uint va, uint i)
 {
-  if (is_init == 0)
+  if (shm->huge)
+    return mapsuper(pgdir, va, shm->pages[i], PTE_W | PTE_U);
+  return mappages(pgdir, (char *)va, PGSIZE, shm->pages[i], PTE_W | PTE_U);
+}
+
+// Map segment shm into the current process (see vmaplace).
+// huge picks the page size of a segment being created.
+// Caller holds shmlock.
+static int
+attach_sharedmem(struct shared_memory *shm, int size, int huge, char **pointer)
+{
+  struct proc *curproc = myproc();
+  struct vma *v;
+  uint i, pgsize;
+
+  if (shm->ref_count > 0)
+    huge = shm->huge;
+  pgsize = huge ? SUPERPGSIZE : PGSIZE;
+  if (size < 0 || size > (huge ? SHMTOP : SHM_MAXPAGES * PGSIZE))
+    return -1;
+  size = (size + pgsize - 1) & ~(pgsize - 1);
+  if (shm->ref_count > 0 && size > shm->size)
+    return -1;
+  if (shm->ref_count == 0 && size == 0)
+    size = pgsize;
+  if (shm->ref_count > 0)
+    size = shm->size;
+  if ((v = vmaplace(curproc, VMA_SHM, size, pgsize)) == 0)
+    return -1;
+  if (shm->ref_count == 0)
   {
-    cprintf("init_shared_memory_table called \n");
-    for (int i = 0; i < MAX_SHARED_MEM; i++)
+    if ((shm->pages = (uint *)kmalloc(size / pgsize * sizeof(uint))) == 0)
     {
-      shared_memory_table[i].id = i;
-      shared_memory_table[i].ref_count = 0;
-      shared_memory_table[i].physical_memory = 0;
-      initsleeplock(&shared_memory_table[i].lock, "shared_memory_table");
+      vmafree(v);
+      return -1;
     }
-    is_init = 1;
+    memset(shm->pages, 0, size / pgsize * sizeof(uint));
+    shm->size = size;
+    shm->huge = huge;
+  }
+
+  v->shmid = shm->id;
+  for (i = 0; i < size / pgsize; i++)
+  {
+    if (shm->pages[i] && mapshmpage(curproc->pgdir, shm, v->start + i * pgsize, i) < 0)
+      panic("attach_sharedmem: mappages");
   }
+  shm->ref_count++;
+  *pointer = (char *)v->start;
+  return 0;
 }
 
-void get_sharedmem(int id, char **pointer)
+// Map segment id into the current process.  A size of 0 attaches
+// with the segment's size; opening a numbered segment that has
+// no references creates it with the given size (at least one
+// page).  Pages other processes have touched are mapped now, the
+// rest on first touch.  A named segment can be opened by id only
+// while it exists.
+int get_sharedmem(int id, int size, char **pointer)
 {
-  init_shared_memory_table();
-  // acquiresleep(&shared_memory_table[id].lock);
-  // cprintf("get_sharedmem called, pid:%d, ref_count:%d\n", myproc()->pid, shared_memory_table[id].ref_count);
-  if (shared_memory_table[id].ref_count == 0)
+  int r;
+
+  if (id < 0 || id >= NSHM)
+    return -1;
+  acquire(&shmlock);
+  if (id >= MAX_SHARED_MEM && shared_memory_table[id].ref_count == 0)
+    r = -1;
+  else
+    r = attach_sharedmem(&shared_memory_table[id], size, 0, pointer);
+  release(&shmlock);
+  return r;
+}
+
+// Open the segment called name, creating it if flags has
+// SHM_CREAT (failing if it exists and flags has SHM_EXCL), of
+// superpages if flags has SHM_HUGE.
+// Returns the segment's id, for the calls that take one.
+int open_named_sharedmem(char *name, int size, int flags, char **pointer)
+{
+  struct shared_memory *shm;
+  int id;
+
+  if (name[0] == 0 || strlen(name) >= SHMNAMESZ)
+    return -1;
+  acquire(&shmlock);
+  if ((shm = lookup_sharedmem(name)) != 0)
   {
-    char *memory = kalloc();
-    if (memory == 0)
+    if ((flags & SHM_CREAT) && (flags & SHM_EXCL))
+      goto bad;
+  }
+  else
+  {
+    if (!(flags & SHM_CREAT))
+      goto bad;
+    for (id = MAX_SHARED_MEM; id < NSHM; id++)
+      if (shared_memory_table[id].ref_count == 0)
+        break;
+    if (id == NSHM)
+      goto bad;
+    shm = &shared_memory_table[id];
+    safestrcpy(shm->name, name, SHMNAMESZ);
+    shm->next = shmhash[shmhashname(name)];
+    shmhash[shmhashname(name)] = shm;
+  }
+  if (attach_sharedmem(shm, size, flags & SHM_HUGE, pointer) < 0)
+  {
+    if (shm->ref_count == 0)
+      unname_sharedmem(shm);
+    goto bad;
+  }
+  release(&shmlock);
+  return shm->id;
+
+bad:
+  release(&shmlock);
+  return -1;
+}
+
+// Describe segment id for ipcs.  Returns -1 if it is not in use.
+int stat_sharedmem(int id, struct shminfo *info)
+{
+  struct shared_memory *shm;
+  struct proc *p;
+  struct vma *v;
+  uint i;
+
+  if (id < 0 || id >= NSHM)
+    return -1;
+  shm = &shared_memory_table[id];
+  acquire(&shmlock);
+  if (shm->ref_count == 0)
+  {
+    release(&shmlock);
+    return -1;
+  }
+  info->id = id;
+  safestrcpy(info->name, shm->name, SHMNAMESZ);
+  info->size = shm->size;
+  info->ref_count = shm->ref_count;
+  info->resident = 0;
+  for (i = 0; i < shm->size / SHMPGSIZE(shm); i++)
+    if (shm->pages[i])
+      info->resident += SHMPGSIZE(shm) / PGSIZE;
+
+  info->npids = 0;
+  acquire(&ptable.lock);
+  for (p = ptable.proc; p < &ptable.proc[NPROC]; p++)
+  {
+    if (p->state == UNUSED)
+      continue;
+    for (v = p->vma; v < &p->vma[NVMA]; v++)
     {
-      panic("get_sharedmem: kalloc failed");
+      if (v->type == VMA_SHM && v->shmid == id)
+      {
+        if (info->npids < SHMSTATPIDS)
+          info->pids[info->npids] = p->pid;
+        info->npids++;
+        break;
+      }
     }
-    struct proc *curproc = myproc();
-    // allocating from the top of user space
-    void *address = (void *)(curproc->top - PGSIZE); // address is virtual, specific to each process
-    curproc->top -= PGSIZE;                          // update top for the next allocation
-    memset(memory, 0, PGSIZE);
-    mappages(curproc->pgdir, address, PGSIZE, V2P(memory), PTE_W | PTE_U);
-    *pointer = address;
-    shared_memory_table[id].physical_memory = V2P(memory);
   }
-  else
+  release(&ptable.lock);
+  release(&shmlock);
+  return 0;
+}
+
+// Count the segments in use and their resident pages for memstat.
+void shmmemstat(struct memstat *ms)
+{
+  struct shared_memory *shm;
+  uint i;
+
+  ms->nshm = ms->shmpages = 0;
+  acquire(&shmlock);
+  for (shm = shared_memory_table; shm < &shared_memory_table[NSHM]; shm++)
   {
-    // get physical address from the page table and map it to the virtual address of this new process
-    uint physical_address = shared_memory_table[id].physical_memory;
-    struct proc *curproc = myproc();
-    void *address = (void *)(curproc->top - PGSIZE);
-    curproc->top -= PGSIZE;
-    mappages(curproc->pgdir, address, PGSIZE, physical_address, PTE_W | PTE_U);
-    *pointer = address;
+    if (shm->ref_count == 0)
+      continue;
+    ms->nshm++;
+    for (i = 0; i < shm->size / SHMPGSIZE(shm); i++)
+      if (shm->pages[i])
+        ms->shmpages += SHMPGSIZE(shm) / PGSIZE;
   }
-  shared_memory_table[id].ref_count++;
-  // releasesleep(&shared_memory_table[id].lock);
+  release(&shmlock);
 }
 
-void dump_sharedmem(int id)
+// Unmap shared memory area v of p and drop its reference,
+// freeing the segment when no process has it open.
+// Caller holds shmlock.
+static void
+unmap_sharedmem(struct proc *p, struct vma *v)
 {
-  init_shared_memory_table();
-  // acquiresleep(&shared_memory_table[id].lock);
-  // cprintf("dump_sharedmem called, pid:%d, ref_count:%d\n", myproc()->pid, shared_memory_table[id].ref_count);
-  if (id >= MAX_SHARED_MEM)
+  struct shared_memory *shm = &shared_memory_table[v->shmid];
+  pte_t *pte;
+  uint a, i;
+
+  // Clear the PTEs without freeing: the pages belong to the segment.
+  for (a = v->start; a < v->end; a += PGSIZE)
+  {
+    if (p->pgdir[PDX(a)] & PTE_PS)
+      p->pgdir[PDX(a)] = 0;
+    else if ((pte = walkpgdir(p->pgdir, (char *)a, 0)) != 0)
+      *pte = 0;
+  }
+  if (p == myproc())
+    lcr3(V2P(p->pgdir));
+  vmafree(v);
+
+  if (--shm->ref_count == 0)
+  {
+    for (i = 0; i < shm->size / SHMPGSIZE(shm); i++)
+    {
+      if (shm->pages[i] && shm->huge)
+        superfree(P2V(shm->pages[i]));
+      else if (shm->pages[i])
+        kfree(P2V(shm->pages[i]));
+    }
+    kmfree(shm->pages);
+    shm->pages = 0;
+    shm->size = 0;
+    if (shm->name[0])
+      unname_sharedmem(shm);
+  }
+}
+
+// Unmap the current process's most recent mapping of segment id.
+int dump_sharedmem(int id)
+{
+  struct proc *curproc = myproc();
+  struct vma *v, *found;
+
+  if (id < 0 || id >= NSHM)
   {
     cprintf("dump_sharedmem: shared mem id out of index\n");
-    return;
+    return -1;
   }
-  if (shared_memory_table[id].ref_count > 0)
+
+  acquire(&shmlock);
+  found = 0;
+  for (v = curproc->vma; v < &curproc->vma[NVMA]; v++)
+    if (v->type == VMA_SHM && v->shmid == id && (found == 0 || v->start < found->start))
+      found = v;
+  if (found == 0)
   {
-    shared_memory_table[id].ref_count--;
+    release(&shmlock);
+    return -1;
   }
-  else
+  unmap_sharedmem(curproc, found);
+  release(&shmlock);
+  return 0;
+}
+
+// Unmap every segment p has open, before its page table is
+// freed (exit, exec, a failed fork).
+void close_all_sharedmem(struct proc *p)
+{
+  struct vma *v;
+
+  acquire(&shmlock);
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+    if (v->type == VMA_SHM)
+      unmap_sharedmem(p, v);
+  release(&shmlock);
+}
+
+// Map parent's segments into child np at the same addresses,
+// sharing their pages.  Returns -1 if out of memory; the caller
+// then undoes the partial work with close_all_sharedmem(np).
+int fork_sharedmem(struct proc *np, struct proc *parent)
+{
+  struct shared_memory *shm;
+  struct vma *v, *nv;
+  uint i;
+
+  acquire(&shmlock);
+  for (v = parent->vma; v < &parent->vma[NVMA]; v++)
   {
-    cprintf("dump_sharedmem: ref_count is 0");
-    return;
+    if (v->type != VMA_SHM)
+      continue;
+    nv = &np->vma[v - parent->vma];
+    *nv = *v;
+    shm = &shared_memory_table[v->shmid];
+    shm->ref_count++;
+    for (i = 0; i < (v->end - v->start) / SHMPGSIZE(shm); i++)
+    {
+      if (shm->pages[i] && mapshmpage(np->pgdir, shm, v->start + i * SHMPGSIZE(shm), i) < 0)
+      {
+        release(&shmlock);
+        return -1;
+      }
+    }
   }
-  if (shared_memory_table[id].ref_count == 0)
+  release(&shmlock);
+  return 0;
+}
+
+// Page fault at va in the current process.  If va lies in a
+// shared memory mapping, give the segment's page a frame (if no
+// process has yet) and map it.  Returns -1 if va is not shared
+// memory or memory is exhausted.
+int sharedmem_fault(uint va)
+{
+  struct proc *curproc = myproc();
+  struct shared_memory *shm;
+  struct vma *v;
+  pte_t *pte;
+  char *mem;
+  uint i;
+
+  if ((v = vmafind(curproc, va)) == 0 || v->type != VMA_SHM)
+    return -1;
+
+  acquire(&shmlock);
+  shm = &shared_memory_table[v->shmid];
+  i = (va - v->start) / SHMPGSIZE(shm);
+  if (curproc->pgdir[PDX(va)] & PTE_PS)
+    goto bad;
+  va = v->start + i * SHMPGSIZE(shm);
+  if ((pte = walkpgdir(curproc->pgdir, (char *)va, 0)) != 0 && (*pte & PTE_P))
+    goto bad; // present: a protection fault
+  if (shm->pages[i] == 0)
   {
-    cprintf("ref count hit 0\n");
-    char *virtual_address = P2V(shared_memory_table[id].physical_memory);
-    memset(virtual_address, 1, PGSIZE);
-    kfree(virtual_address);
-    shared_memory_table[id].physical_memory = 0;
+    if (shm->huge)
+    {
+      if ((mem = superalloc()) == 0)
+        goto bad;
+      memset(mem, 0, SUPERPGSIZE);
+    }
+    else if ((mem = kzalloc()) == 0)
+      goto bad;
+    shm->pages[i] = V2P(mem);
   }
-  // releasesleep(&shared_memory_table[id].lock);
+  if (mapshmpage(curproc->pgdir, shm, va, i) < 0)
+    goto bad;
+  release(&shmlock);
+  return 0;
+
+bad:
+  release(&shmlock);
+  return -1;
 }
 
 void get_sharedmem_lock(int id)
 {
-  // while (shared_memory_table[id].lock.pid != 0)
-  // {
-  //   cprintf("ll\n");
-  // };
   acquiresleep(&shared_memory_table[id].lock);
 }
 
 void let_sharedmem_lock(int id)
 {
-  // while (shared_memory_table[id].lock.pid == 0)
-  // {
-  //   cprintf("ee\n");
-  // };
-  // cprintf("dd\n");
   releasesleep(&shared_memory_table[id].lock);
 }
 
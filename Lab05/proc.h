@@ -44,6 +44,32 @@ enum procstate
   ZOMBIE
 };
 
+// lab 5
+// A region of a user address space (see vma.c).
+enum vmatype
+{
+  VMA_FREE,
+  VMA_TEXT,  // text and data
+  VMA_STACK, // user stack and its guard page
+  VMA_HEAP,  // grows with sbrk, ends at sz
+  VMA_SHM,   // shared memory segment shmid
+  VMA_MMAP   // file mapping (see mmap.c)
+};
+
+struct vma
+{
+  enum vmatype type;
+  uint start; // first address, page aligned
+  uint end;   // one past the last address
+  int shmid;
+  struct file *file; // VMA_MMAP: the mapped file,
+  uint off;          // offset of start in the file (also VMA_TEXT),
+  int prot;          // PROT_ bits
+  int flags;         // and MAP_SHARED or MAP_PRIVATE
+  struct inode *ip;  // VMA_TEXT: the program, paged in by execfault,
+  uint filesz;       // and the bytes from off that come from it
+};
+
 // Per-process state
 struct proc
 {
@@ -62,7 +88,10 @@ struct proc
   char name[16];              // Process name (debugging)
   // lab 5
   //  char *shared_memory;
-  int top; // top of user space, we had to add this to each proc, because it's virtual (unique for each proc)
+  struct vma vma[NVMA];       // Regions of the address space
+  struct proc *ksnext;        // Next waiter on a ksync object
+  int ksdone;                 // Dequeued by a ksync waker
+  int superpages;             // Back the heap with superpages
 };
 
 // Process memory is laid out contiguously, low addresses first:
@@ -0,0 +1,20 @@
+// lab 5
+// Named shared memory segments (shm_open) and their listing (shm_stat).
+
+#define SHM_CREAT 0x1 // create the segment if it does not exist
+#define SHM_EXCL  0x2 // with SHM_CREAT, fail if it exists
+#define SHM_HUGE  0x4 // with SHM_CREAT, back it with 4MB superpages
+
+#define SHMNAMESZ 16
+#define SHMSTATPIDS 8
+
+struct shminfo
+{
+  int id;
+  char name[SHMNAMESZ]; // empty for a numbered segment
+  uint size;            // bytes
+  int ref_count;
+  int resident;         // pages with a frame
+  int npids;            // attached processes; the first SHMSTATPIDS are listed
+  int pids[SHMSTATPIDS];
+};
@@ -0,0 +1,82 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "shm.h"
+
+// A multi-page segment shared by a parent and the child that
+// inherits it through fork.  The parent writes a stamp into every other page, the child
+// checks them and stamps the remaining pages, and the parent
+// checks the child's stamps.  Untouched pages are never
+// allocated until one of them writes.  Finally, reopening a
+// closed segment must reuse its address range, and named
+// segments must honour SHM_CREAT and SHM_EXCL.
+
+#define MEM_ID 1
+#define SIZE (1024 * 1024)
+#define PGSIZE 4096
+#define NPAGES (SIZE / PGSIZE)
+
+int check(int *buf, int parity)
+{
+    int i, bad = 0;
+
+    for (i = parity; i < NPAGES; i += 2)
+        if (buf[i * PGSIZE / sizeof(int)] != i)
+            bad++;
+    return bad;
+}
+
+int main(int argc, char *argv[])
+{
+    int *buf, i, id;
+    char *named, *again;
+
+    if (open_sharedmem(MEM_ID, SIZE, (char **)&buf) < 0)
+    {
+        printf(1, "shmtest: open_sharedmem failed\n");
+        exit();
+    }
+    for (i = 0; i < NPAGES; i += 2)
+        buf[i * PGSIZE / sizeof(int)] = i;
+
+    if (fork() == 0)
+    {
+        // exit() drops the child's reference.
+        printf(1, "child: %d bad pages from parent\n", check(buf, 0));
+        for (i = 1; i < NPAGES; i += 2)
+            buf[i * PGSIZE / sizeof(int)] = i;
+        exit();
+    }
+    wait();
+    printf(1, "parent: %d bad pages from child\n", check(buf, 1));
+    close_sharedmem(MEM_ID);
+
+    for (i = 0; i < 1000; i++)
+    {
+        if (open_sharedmem(MEM_ID, SIZE, &again) < 0 || (int *)again != buf)
+        {
+            printf(1, "shmtest: reopen %d mapped at %p, not %p\n", i, again, buf);
+            exit();
+        }
+        close_sharedmem(MEM_ID);
+    }
+    printf(1, "reopened 1000 times at %p\n", buf);
+
+    if (shm_open("shmtest", PGSIZE, 0, &named) >= 0)
+        printf(1, "shmtest: opened a missing segment without SHM_CREAT\n");
+    if ((id = shm_open("shmtest", PGSIZE, SHM_CREAT | SHM_EXCL, &named)) < 0)
+        printf(1, "shmtest: shm_open create failed\n");
+    if (shm_open("shmtest", 0, SHM_CREAT | SHM_EXCL, &again) >= 0)
+        printf(1, "shmtest: SHM_EXCL opened an existing segment\n");
+    if (shm_open("shmtest", 0, 0, &again) != id)
+        printf(1, "shmtest: reopening by name gave another id\n");
+    strcpy(named, "hello");
+    if (strcmp(again, "hello") != 0)
+        printf(1, "shmtest: named mappings differ\n");
+    close_sharedmem(id);
+    close_sharedmem(id);
+    if (shm_open("shmtest", 0, 0, &again) >= 0)
+        printf(1, "shmtest: named segment outlived its last close\n");
+    printf(1, "named segment %d ok\n", id);
+    exit();
+}
@@ -0,0 +1,283 @@
+// lab 5
+// Slab allocator for small kernel objects.
+//
+// A cache hands out objects of one size, carved from slabs: pages
+// that begin with a struct slab header followed by the objects,
+// so an object's slab is found by rounding its address down.
+// Each CPU keeps a magazine of up to KMAGSIZE free objects of
+// every cache and allocates and frees through it without taking
+// the cache's lock; only an empty or full magazine goes to the
+// slabs, KMAGSIZE/2 objects at a time.  A slab whose objects are
+// all free goes back to kalloc unless it is the cache's last.
+//
+// kmalloc() serves other sizes up to a page from a set of
+// power-of-two caches, and whole pages above that.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "spinlock.h"
+#include "memstat.h"
+
+#define NCACHE 16   // caches, including kmalloc's
+#define KMAGSIZE 16 // objects in a per-CPU magazine
+#define KMINSIZE 32 // smallest kmalloc size
+#define KMAXSIZE 1024 // largest kmalloc size served by a cache
+
+struct slab
+{
+  struct kmem_cache *cache;
+  struct slab *next; // in cache->partial
+  struct slab *prev;
+  void *freelist;    // free objects, linked through their first word
+  int nfree;
+};
+
+#define SLABHDR ((sizeof(struct slab) + 7) & ~7)
+
+struct kmag
+{
+  int n;
+  void *obj[KMAGSIZE];
+  uint nalloc; // objects handed out by this CPU
+  uint nfree;  // and returned to it
+};
+
+struct kmem_cache
+{
+  char name[16];
+  uint size;     // object size, a multiple of 8
+  uint perslab;  // objects per slab
+  struct spinlock lock;
+  struct slab *partial; // slabs with free objects
+  uint nslab;    // slabs held
+  struct kmag mag[NCPU];
+};
+
+static char *kmallocname[] = {
+    "kmalloc-32", "kmalloc-64", "kmalloc-128",
+    "kmalloc-256", "kmalloc-512", "kmalloc-1024",
+};
+
+struct
+{
+  struct spinlock lock;
+  struct kmem_cache cache[NCACHE];
+  int ncache;
+  struct kmem_cache *kmalloc[NELEM(kmallocname)]; // KMINSIZE << i bytes
+} slab;
+
+void slabinit(void)
+{
+  int i;
+
+  initlock(&slab.lock, "slab");
+  for (i = 0; i < NELEM(kmallocname); i++)
+    slab.kmalloc[i] = kmem_cache_create(kmallocname[i], KMINSIZE << i);
+}
+
+// Make a cache of objects of the given size (at most KMAXSIZE).
+struct kmem_cache *
+kmem_cache_create(char *name, uint size)
+{
+  struct kmem_cache *c;
+
+  if (size == 0 || size > KMAXSIZE)
+    panic("kmem_cache_create: size");
+  acquire(&slab.lock);
+  if (slab.ncache == NCACHE)
+    panic("kmem_cache_create: too many caches");
+  c = &slab.cache[slab.ncache++];
+  release(&slab.lock);
+
+  memset(c, 0, sizeof(*c));
+  safestrcpy(c->name, name, sizeof(c->name));
+  c->size = (size + 7) & ~7;
+  c->perslab = (PGSIZE - SLABHDR) / c->size;
+  initlock(&c->lock, c->name);
+  return c;
+}
+
+static void
+unlinkslab(struct kmem_cache *c, struct slab *s)
+{
+  if (s->prev)
+    s->prev->next = s->next;
+  else
+    c->partial = s->next;
+  if (s->next)
+    s->next->prev = s->prev;
+}
+
+// Take a free object from c's slabs, growing c by a slab
+// if none has one.  Caller holds c->lock.
+static void *
+takeobj(struct kmem_cache *c)
+{
+  struct slab *s;
+  char *p;
+  void *obj;
+  uint i;
+
+  if ((s = c->partial) == 0)
+  {
+    if ((s = (struct slab *)kalloc()) == 0)
+      return 0;
+    s->cache = c;
+    s->freelist = 0;
+    p = (char *)s + SLABHDR;
+    for (i = 0; i < c->perslab; i++, p += c->size)
+    {
+      *(void **)p = s->freelist;
+      s->freelist = p;
+    }
+    s->nfree = c->perslab;
+    s->prev = 0;
+    s->next = 0;
+    c->partial = s;
+    c->nslab++;
+  }
+  obj = s->freelist;
+  s->freelist = *(void **)obj;
+  if (--s->nfree == 0)
+    unlinkslab(c, s);
+  return obj;
+}
+
+// Return obj to its slab.  Caller holds c->lock.
+static void
+putobj(struct kmem_cache *c, void *obj)
+{
+  struct slab *s = (struct slab *)PGROUNDDOWN((uint)obj);
+
+  *(void **)obj = s->freelist;
+  s->freelist = obj;
+  if (s->nfree++ == 0)
+  {
+    s->prev = 0;
+    s->next = c->partial;
+    if (c->partial)
+      c->partial->prev = s;
+    c->partial = s;
+  }
+  if (s->nfree == c->perslab && (s->prev || s->next))
+  {
+    unlinkslab(c, s);
+    c->nslab--;
+    kfree((char *)s);
+  }
+}
+
+// Allocate an object from c.  Returns 0 if out of memory.
+void *
+kmem_cache_alloc(struct kmem_cache *c)
+{
+  struct kmag *m;
+  void *obj;
+
+  pushcli();
+  m = &c->mag[cpuid()];
+  if (m->n == 0)
+  {
+    acquire(&c->lock);
+    while (m->n < KMAGSIZE / 2 && (obj = takeobj(c)) != 0)
+      m->obj[m->n++] = obj;
+    release(&c->lock);
+  }
+  obj = 0;
+  if (m->n > 0)
+  {
+    obj = m->obj[--m->n];
+    m->nalloc++;
+  }
+  popcli();
+  return obj;
+}
+
+void kmem_cache_free(struct kmem_cache *c, void *obj)
+{
+  struct kmag *m;
+
+  pushcli();
+  m = &c->mag[cpuid()];
+  if (m->n == KMAGSIZE)
+  {
+    acquire(&c->lock);
+    while (m->n > KMAGSIZE / 2)
+      putobj(c, m->obj[--m->n]);
+    release(&c->lock);
+  }
+  m->obj[m->n++] = obj;
+  m->nfree++;
+  popcli();
+}
+
+// Allocate n bytes, at most PGSIZE.  Returns 0 if out of memory.
+void *
+kmalloc(uint n)
+{
+  int i;
+
+  if (n > PGSIZE)
+    return 0;
+  if (n > KMAXSIZE)
+    return kalloc();
+  for (i = 0; (KMINSIZE << i) < n; i++)
+    ;
+  return kmem_cache_alloc(slab.kmalloc[i]);
+}
+
+// Free memory from kmalloc.  Objects never start a page, so
+// a page-aligned p is a whole page.
+void kmfree(void *p)
+{
+  if ((uint)p % PGSIZE == 0)
+    kfree(p);
+  else
+    kmem_cache_free(((struct slab *)PGROUNDDOWN((uint)p))->cache, p);
+}
+
+static void
+cachestat(struct kmem_cache *c, struct slabstat *st)
+{
+  uint nfree;
+  int i;
+
+  safestrcpy(st->name, c->name, sizeof(st->name));
+  st->size = c->size;
+  st->nslab = c->nslab;
+  st->nalloc = nfree = 0;
+  for (i = 0; i < NCPU; i++)
+  {
+    st->nalloc += c->mag[i].nalloc;
+    nfree += c->mag[i].nfree;
+  }
+  st->inuse = st->nalloc - nfree;
+}
+
+// Fill in the statistics of up to max caches; returns how many.
+int slabstat(struct slabstat *st, int max)
+{
+  int n;
+
+  for (n = 0; n < max && n < slab.ncache; n++)
+    cachestat(&slab.cache[n], &st[n]);
+  return n;
+}
+
+// Print each cache's statistics (see procdump).
+void slabdump(void)
+{
+  struct slabstat st;
+  int i;
+
+  for (i = 0; i < slab.ncache; i++)
+  {
+    cachestat(&slab.cache[i], &st);
+    cprintf("%s: size %d, %d slabs, %d in use, %d allocs\n",
+            st.name, st.size, st.nslab, st.inuse, st.nalloc);
+  }
+}
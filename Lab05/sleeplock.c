@@ -10,23 +10,58 @@
 #include "spinlock.h"
 #include "sleeplock.h"
 
+// How many times a waiter polls the lock while its holder is
+// running on another CPU before it gives up and sleeps.
+#define SLEEPLOCK_SPIN 1000
+
 void
 initsleeplock(struct sleeplock *lk, char *name)
 {
   initlock(&lk->lk, "sleep lock");
   lk->name = name;
   lk->locked = 0;
+  lk->owner = 0;
   lk->pid = 0;
 }
 
+// Wait briefly for lk to be released, as long as its holder is
+// running on another CPU and so is likely to release it soon.
+// Called without lk->lk held; the owner check is a racy hint.
+static void
+spinsleep(struct sleeplock *lk)
+{
+  struct proc *owner;
+  int i;
+
+  for(i = 0; i < SLEEPLOCK_SPIN; i++){
+    if(*(volatile uint*)&lk->locked == 0)
+      return;
+    owner = *(struct proc* volatile*)&lk->owner;
+    if(owner == 0 || owner->state != RUNNING)
+      return;
+    pause();
+  }
+}
+
+// Acquire lk, spinning while the holder runs on another CPU
+// and sleeping otherwise, which saves the two trips through
+// scheduler() that a short critical section would cost.
 void
 acquiresleep(struct sleeplock *lk)
 {
   acquire(&lk->lk);
   while (lk->locked) {
+    if(lk->owner && lk->owner != myproc() && lk->owner->state == RUNNING){
+      release(&lk->lk);
+      spinsleep(lk);
+      acquire(&lk->lk);
+      if(!lk->locked)
+        break;
+    }
     sleep(lk, &lk->lk);
   }
   lk->locked = 1;
+  lk->owner = myproc();
   lk->pid = myproc()->pid;
   release(&lk->lk);
 }
@@ -36,6 +71,7 @@ releasesleep(struct sleeplock *lk)
 {
   acquire(&lk->lk);
   lk->locked = 0;
+  lk->owner = 0;
   lk->pid = 0;
   wakeup(lk);
   release(&lk->lk);
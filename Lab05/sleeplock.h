@@ -3,6 +3,8 @@ struct sleeplock {
   uint locked;       // Is the lock held?
   struct spinlock lk; // spinlock protecting this sleep lock
   
+  struct proc *owner; // Process holding lock, for adaptive spinning
+
   // For debugging:
   char *name;        // Name of lock.
   int pid;           // Process holding lock
@@ -0,0 +1,117 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+
+// Fork-join signalling cost: NWORKERS children run ROUNDS
+// rounds; in each the parent releases them and waits for all of
+// them to finish.  Compares pipes, semaphores and a barrier.
+
+#define NWORKERS 4
+#define ROUNDS 500
+
+int bench_pipe(void)
+{
+    int start, i, r, startp[2], donep[2];
+    char c = 0;
+
+    pipe(startp);
+    pipe(donep);
+    start = uptime();
+    for (i = 0; i < NWORKERS; i++)
+    {
+        if (fork() == 0)
+        {
+            for (r = 0; r < ROUNDS; r++)
+            {
+                read(startp[0], &c, 1);
+                write(donep[1], &c, 1);
+            }
+            exit();
+        }
+    }
+    for (r = 0; r < ROUNDS; r++)
+    {
+        for (i = 0; i < NWORKERS; i++)
+            write(startp[1], &c, 1);
+        for (i = 0; i < NWORKERS; i++)
+            read(donep[0], &c, 1);
+    }
+    for (i = 0; i < NWORKERS; i++)
+        wait();
+    close(startp[0]);
+    close(startp[1]);
+    close(donep[0]);
+    close(donep[1]);
+    return uptime() - start;
+}
+
+int bench_sem(void)
+{
+    int start, i, r, go, done;
+
+    go = sem_create(0);
+    done = sem_create(0);
+    start = uptime();
+    for (i = 0; i < NWORKERS; i++)
+    {
+        if (fork() == 0)
+        {
+            for (r = 0; r < ROUNDS; r++)
+            {
+                sem_wait(go);
+                sem_post(done);
+            }
+            exit();
+        }
+    }
+    for (r = 0; r < ROUNDS; r++)
+    {
+        for (i = 0; i < NWORKERS; i++)
+            sem_post(go);
+        for (i = 0; i < NWORKERS; i++)
+            sem_wait(done);
+    }
+    for (i = 0; i < NWORKERS; i++)
+        wait();
+    sync_free(go);
+    sync_free(done);
+    return uptime() - start;
+}
+
+int bench_barrier(void)
+{
+    int start, i, r, b;
+
+    b = barrier_create(NWORKERS + 1);
+    start = uptime();
+    for (i = 0; i < NWORKERS; i++)
+    {
+        if (fork() == 0)
+        {
+            for (r = 0; r < ROUNDS; r++)
+            {
+                barrier_wait(b); // start of round
+                barrier_wait(b); // end of round
+            }
+            exit();
+        }
+    }
+    for (r = 0; r < ROUNDS; r++)
+    {
+        barrier_wait(b);
+        barrier_wait(b);
+    }
+    for (i = 0; i < NWORKERS; i++)
+        wait();
+    sync_free(b);
+    return uptime() - start;
+}
+
+int main(int argc, char *argv[])
+{
+    printf(1, "%d workers, %d rounds\n", NWORKERS, ROUNDS);
+    printf(1, "pipe:      %d ticks\n", bench_pipe());
+    printf(1, "semaphore: %d ticks\n", bench_sem());
+    printf(1, "barrier:   %d ticks\n", bench_barrier());
+    exit();
+}
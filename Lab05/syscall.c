@@ -50,22 +50,39 @@ int argint(int n, int *ip)
   return fetchint((myproc()->tf->esp) + 4 + 4 * n, ip);
 }
 
-// Fetch the nth word-sized system call argument as a pointer
-// to a block of memory of size bytes.  Check that the pointer
-// lies within the process address space.
-int argptr(int n, char **pp, int size)
+static int
+fetchptr(int n, char **pp, int size, int write)
 {
   int i;
-  struct proc *curproc = myproc();
 
   if (argint(n, &i) < 0)
     return -1;
-  if (size < 0 || (uint)i >= curproc->sz || (uint)i + size > curproc->sz)
+  if (size < 0)
+    return -1;
+  // lab 5: the block may lie anywhere in the process's areas;
+  // vmaaccess checks that and pages in program and file pages,
+  // which cannot be faulted in while the kernel holds locks.
+  if (vmaaccess(i, (uint)i + size, write) < 0)
     return -1;
   *pp = (char *)i;
   return 0;
 }
 
+// Fetch the nth word-sized system call argument as a pointer
+// to a block of memory of size bytes.  Check that the pointer
+// lies within the process address space.
+int argptr(int n, char **pp, int size)
+{
+  return fetchptr(n, pp, size, 0);
+}
+
+// Like argptr, for a block the system call stores into,
+// which must therefore not be a read-only mapping.
+int argoutptr(int n, char **pp, int size)
+{
+  return fetchptr(n, pp, size, 1);
+}
+
 // Fetch the nth word-sized system call argument as a string pointer.
 // Check that the pointer is valid and the string is nul-terminated.
 // (There is no shared writable memory, so the string can't change
@@ -103,6 +120,23 @@ extern int sys_open_sharedmem(void);
 extern int sys_close_sharedmem(void);
 extern int sys_acquire_sharedmem_lock(void);
 extern int sys_release_sharedmem_lock(void);
+extern int sys_sem_create(void);
+extern int sys_sem_wait(void);
+extern int sys_sem_post(void);
+extern int sys_cond_create(void);
+extern int sys_cond_wait(void);
+extern int sys_cond_signal(void);
+extern int sys_cond_broadcast(void);
+extern int sys_barrier_create(void);
+extern int sys_barrier_wait(void);
+extern int sys_sync_free(void);
+extern int sys_shm_open(void);
+extern int sys_shm_stat(void);
+extern int sys_mmap(void);
+extern int sys_munmap(void);
+extern int sys_pagecount(void);
+extern int sys_superpages(void);
+extern int sys_memstat(void);
 
 static int (*syscalls[])(void) = {
     [SYS_fork] sys_fork,
@@ -130,6 +164,23 @@ static int (*syscalls[])(void) = {
     [SYS_close_sharedmem] sys_close_sharedmem,
     [SYS_acquire_sharedmem_lock] sys_acquire_sharedmem_lock,
     [SYS_release_sharedmem_lock] sys_release_sharedmem_lock,
+    [SYS_sem_create] sys_sem_create,
+    [SYS_sem_wait] sys_sem_wait,
+    [SYS_sem_post] sys_sem_post,
+    [SYS_cond_create] sys_cond_create,
+    [SYS_cond_wait] sys_cond_wait,
+    [SYS_cond_signal] sys_cond_signal,
+    [SYS_cond_broadcast] sys_cond_broadcast,
+    [SYS_barrier_create] sys_barrier_create,
+    [SYS_barrier_wait] sys_barrier_wait,
+    [SYS_sync_free] sys_sync_free,
+    [SYS_shm_open] sys_shm_open,
+    [SYS_shm_stat] sys_shm_stat,
+    [SYS_mmap] sys_mmap,
+    [SYS_munmap] sys_munmap,
+    [SYS_pagecount] sys_pagecount,
+    [SYS_superpages] sys_superpages,
+    [SYS_memstat] sys_memstat,
 };
 
 void syscall(void)
@@ -24,4 +24,21 @@
 #define SYS_open_sharedmem 22
 #define SYS_close_sharedmem 23
 #define SYS_acquire_sharedmem_lock 24
-#define SYS_release_sharedmem_lock 25
\ No newline at end of file
+#define SYS_release_sharedmem_lock 25
+#define SYS_sem_create 26
+#define SYS_sem_wait 27
+#define SYS_sem_post 28
+#define SYS_cond_create 29
+#define SYS_cond_wait 30
+#define SYS_cond_signal 31
+#define SYS_cond_broadcast 32
+#define SYS_barrier_create 33
+#define SYS_barrier_wait 34
+#define SYS_sync_free 35
+#define SYS_shm_open 36
+#define SYS_shm_stat 37
+#define SYS_mmap 38
+#define SYS_munmap 39
+#define SYS_pagecount 40
+#define SYS_superpages 41
+#define SYS_memstat 42
\ No newline at end of file
@@ -73,7 +73,7 @@ sys_read(void)
   int n;
   char *p;
 
-  if(argfd(0, 0, &f) < 0 || argint(2, &n) < 0 || argptr(1, &p, n) < 0)
+  if(argfd(0, 0, &f) < 0 || argint(2, &n) < 0 || argoutptr(1, &p, n) < 0)
     return -1;
   return fileread(f, p, n);
 }
@@ -109,7 +109,7 @@ sys_fstat(void)
   struct file *f;
   struct stat *st;
 
-  if(argfd(0, 0, &f) < 0 || argptr(1, (void*)&st, sizeof(*st)) < 0)
+  if(argfd(0, 0, &f) < 0 || argoutptr(1, (void*)&st, sizeof(*st)) < 0)
     return -1;
   return filestat(f, st);
 }
@@ -256,9 +256,16 @@ create(char *path, short type, short major, short minor)
     iunlockput(ip);
     return 0;
   }
+  if(dirinum(dp, name, 0) != 0){
+    // name exists, but there was no memory for its inode.
+    iunlockput(dp);
+    return 0;
+  }
 
-  if((ip = ialloc(dp->dev, type)) == 0)
-    panic("create: ialloc");
+  if((ip = ialloc(dp->dev, type)) == 0){
+    iunlockput(dp);
+    return 0;
+  }
 
   ilock(ip);
   ip->major = major;
@@ -426,7 +433,7 @@ sys_pipe(void)
   struct file *rf, *wf;
   int fd0, fd1;
 
-  if(argptr(0, (void*)&fd, 2*sizeof(fd[0])) < 0)
+  if(argoutptr(0, (void*)&fd, 2*sizeof(fd[0])) < 0)
     return -1;
   if(pipealloc(&rf, &wf) < 0)
     return -1;
@@ -442,3 +449,26 @@ sys_pipe(void)
   fd[1] = fd1;
   return 0;
 }
+
+// lab 5
+int
+sys_mmap(void)
+{
+  struct file *f;
+  int addr, length, prot, flags, off;
+
+  if(argint(0, &addr) < 0 || argint(1, &length) < 0 || argint(2, &prot) < 0 ||
+     argint(3, &flags) < 0 || argfd(4, 0, &f) < 0 || argint(5, &off) < 0)
+    return -1;
+  return mmap_file(f, addr, length, prot, flags, off);
+}
+
+int
+sys_munmap(void)
+{
+  int addr, length;
+
+  if(argint(0, &addr) < 0 || argint(1, &length) < 0)
+    return -1;
+  return munmap_file(addr, length);
+}
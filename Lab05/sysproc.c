@@ -6,6 +6,8 @@
 #include "memlayout.h"
 #include "mmu.h"
 #include "proc.h"
+#include "shm.h"
+#include "memstat.h"
 
 int sys_fork(void)
 {
@@ -87,20 +89,18 @@ int sys_uptime(void)
 // lab 5
 int sys_open_sharedmem(void)
 {
-  int id;
+  int id, size;
   argint(0, &id);
-  if (id < 0)
+  if (id < 0 || argint(1, &size) < 0)
   {
     return -1;
   }
   char **val;
-  if (argptr(1, (void *)&val, sizeof(char **)) < 0)
+  if (argoutptr(2, (void *)&val, sizeof(char **)) < 0)
   {
     return -1;
   }
-  get_sharedmem(id, val);
-
-  return 0;
+  return get_sharedmem(id, size, val);
 }
 
 int sys_close_sharedmem(void)
@@ -111,15 +111,36 @@ int sys_close_sharedmem(void)
   {
     return -1;
   }
-  dump_sharedmem(id);
-  return 0;
+  return dump_sharedmem(id);
+}
+
+int sys_shm_open(void)
+{
+  char *name;
+  int size, flags;
+  char **val;
+
+  if (argstr(0, &name) < 0 || argint(1, &size) < 0 || argint(2, &flags) < 0 ||
+      argoutptr(3, (void *)&val, sizeof(char **)) < 0)
+    return -1;
+  return open_named_sharedmem(name, size, flags, val);
+}
+
+int sys_shm_stat(void)
+{
+  int id;
+  struct shminfo *info;
+
+  if (argint(0, &id) < 0 || argoutptr(1, (void *)&info, sizeof(*info)) < 0)
+    return -1;
+  return stat_sharedmem(id, info);
 }
 
 int sys_acquire_sharedmem_lock()
 {
   int id;
   argint(0, &id);
-  if (id < 0)
+  if (id < 0 || id >= NSHM)
   {
     return -1;
   }
@@ -131,10 +152,147 @@ int sys_release_sharedmem_lock()
 {
   int id;
   argint(0, &id);
-  if (id < 0)
+  if (id < 0 || id >= NSHM)
   {
     return -1;
   }
   let_sharedmem_lock(id);
   return 0;
-}
\ No newline at end of file
+}
+
+int sys_sem_create(void)
+{
+  int value;
+
+  if (argint(0, &value) < 0)
+    return -1;
+  return semcreate(value);
+}
+
+int sys_sem_wait(void)
+{
+  int h;
+
+  if (argint(0, &h) < 0)
+    return -1;
+  return semwait(h);
+}
+
+int sys_sem_post(void)
+{
+  int h;
+
+  if (argint(0, &h) < 0)
+    return -1;
+  return sempost(h);
+}
+
+int sys_cond_create(void)
+{
+  return condcreate();
+}
+
+int sys_cond_wait(void)
+{
+  int h, mutex;
+
+  if (argint(0, &h) < 0 || argint(1, &mutex) < 0)
+    return -1;
+  return condwait(h, mutex);
+}
+
+int sys_cond_signal(void)
+{
+  int h;
+
+  if (argint(0, &h) < 0)
+    return -1;
+  return condsignal(h, 0);
+}
+
+int sys_cond_broadcast(void)
+{
+  int h;
+
+  if (argint(0, &h) < 0)
+    return -1;
+  return condsignal(h, 1);
+}
+
+int sys_barrier_create(void)
+{
+  int n;
+
+  if (argint(0, &n) < 0)
+    return -1;
+  return barriercreate(n);
+}
+
+int sys_barrier_wait(void)
+{
+  int h;
+
+  if (argint(0, &h) < 0)
+    return -1;
+  return barrierwait(h);
+}
+
+int sys_sync_free(void)
+{
+  int h;
+
+  if (argint(0, &h) < 0)
+    return -1;
+  return ksyncfree(h);
+}
+
+// Report the caller's resident and reserved page counts.
+int sys_pagecount(void)
+{
+  int *resident, *reserved;
+  struct proc *curproc = myproc();
+
+  if (argoutptr(0, (void *)&resident, sizeof(*resident)) < 0 ||
+      argoutptr(1, (void *)&reserved, sizeof(*reserved)) < 0)
+    return -1;
+  *resident = uvmresident(curproc->pgdir);
+  *reserved = vmareserved(curproc);
+  return 0;
+}
+
+// Back the caller's heap with 4MB superpages (on != 0) or
+// 4KB pages from now on; the setting is inherited by children
+// and kept across exec.  Returns the previous setting.
+int sys_superpages(void)
+{
+  struct proc *curproc = myproc();
+  int on, old;
+
+  if (argint(0, &on) < 0)
+    return -1;
+  old = curproc->superpages;
+  curproc->superpages = on != 0;
+  return old;
+}
+
+// Fill in *ms with the system's memory statistics.
+int sys_memstat(void)
+{
+  struct memstat *ms, *k;
+
+  if (argoutptr(0, (void *)&ms, sizeof(*ms)) < 0)
+    return -1;
+  // Gather into kernel memory, so that no page fault on ms can
+  // happen while the statistics' locks are held.
+  if ((k = kmalloc(sizeof(*k))) == 0)
+    return -1;
+  kmemstat(k);
+  faultstat(k->faults);
+  shmmemstat(k);
+  k->pcachepages = pcachecount();
+  k->nslab = slabstat(k->slab, MSSLABS);
+  procmemstat(k);
+  memmove(ms, k, sizeof(*k));
+  kmfree(k);
+  return 0;
+}
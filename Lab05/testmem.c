@@ -7,7 +7,7 @@ void calculate_factorial(int index, int num)
 {
     char *val = 0;
 
-    open_sharedmem(MEM_ID, &val);   
+    open_sharedmem(MEM_ID, sizeof(int), &val);   
     acquire_sharedmem_lock(MEM_ID); 
 
     int *shared_val = (int *)val; 
@@ -37,7 +37,7 @@ int main(int argc, char *argv[])
 
     char *val = 0;
 
-    open_sharedmem(MEM_ID, &val);   
+    open_sharedmem(MEM_ID, sizeof(int), &val);   
     acquire_sharedmem_lock(MEM_ID); 
 
     int *shared_val = (int *)val;   
@@ -7,7 +7,7 @@ void calculate_factorial(int index, int num)
 {
     char *val = 0;
 
-    open_sharedmem(MEM_ID, &val);
+    open_sharedmem(MEM_ID, sizeof(int), &val);
 
     int *shared_val = (int *)val; 
     *shared_val *= num;           
@@ -35,7 +35,7 @@ int main(int argc, char *argv[])
 
     char *val = 0;
 
-    open_sharedmem(MEM_ID, &val);   
+    open_sharedmem(MEM_ID, sizeof(int), &val);   
 
     int *shared_val = (int *)val;   
     *shared_val = 1;                
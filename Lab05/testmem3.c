@@ -0,0 +1,115 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "uatomic.h"
+#define MEM_ID 0
+#define ITERS 20000
+
+// testmem with the lock and counters kept in the shared page:
+// the factorial update and the bookkeeping run without system
+// calls.  A second pass times the kernel lock against the
+// in-page spin lock and a lock-free fetch-and-add.
+
+struct shared
+{
+    struct uspinlock lock;
+    int factorial;
+    struct ucounter done;
+    struct ucounter hits;
+};
+
+void calculate_factorial(struct shared *s, int index, int num)
+{
+    uspin_lock(&s->lock);
+    s->factorial *= num;
+    printf(1, "Process %d updated factorial to: %d\n", index, s->factorial);
+    uspin_unlock(&s->lock);
+    ucounter_add(&s->done, 1);
+}
+
+void run(int number, int mode, struct shared *s)
+{
+    int start, i, j;
+
+    s->hits.value = 0;
+    start = uptime();
+    for (i = 0; i < number; i++)
+    {
+        if (fork() == 0)
+        {
+            for (j = 0; j < ITERS; j++)
+            {
+                if (mode == 0)
+                {
+                    acquire_sharedmem_lock(MEM_ID);
+                    s->hits.value++;
+                    release_sharedmem_lock(MEM_ID);
+                }
+                else if (mode == 1)
+                {
+                    uspin_lock(&s->lock);
+                    s->hits.value++;
+                    uspin_unlock(&s->lock);
+                }
+                else
+                    ucounter_add(&s->hits, 1);
+            }
+            exit();
+        }
+    }
+    for (i = 0; i < number; i++)
+        wait();
+    printf(1, "%s: %d increments in %d ticks (expected %d)\n",
+           mode == 0 ? "kernel lock" : mode == 1 ? "uspinlock" : "fetch_add",
+           ucounter_read(&s->hits), uptime() - start, number * ITERS);
+}
+
+int main(int argc, char *argv[])
+{
+    struct shared *s;
+    char *val = 0;
+    int i, number, mode;
+
+    if (argc != 2)
+    {
+        printf(1, "Usage: %s <number>\n", argv[0]);
+        exit();
+    }
+
+    number = atoi(argv[1]);
+    if (number < 0)
+    {
+        printf(1, "Error: Factorial is not defined for negative numbers.\n");
+        exit();
+    }
+
+    printf(1, "Starting factorial calculation for %d\n", number);
+
+    if (open_sharedmem(MEM_ID, sizeof(struct shared), &val) < 0)
+    {
+        printf(1, "testmem3: open_sharedmem failed\n");
+        exit();
+    }
+    s = (struct shared *)val;
+    s->lock.locked = 0;
+    s->factorial = 1;
+    s->done.value = 0;
+
+    for (i = 1; i <= number; i++)
+    {
+        if (fork() == 0)
+        {
+            calculate_factorial(s, i, i);
+            exit();
+        }
+    }
+    for (i = 1; i <= number; i++)
+        wait();
+    printf(1, "%d! = %d, %d processes done\n", number, s->factorial, ucounter_read(&s->done));
+
+    for (mode = 0; mode < 3; mode++)
+        run(number, mode, s);
+
+    close_sharedmem(MEM_ID);
+    exit();
+}
@@ -0,0 +1,109 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "shm.h"
+
+// TLB reach with 4KB pages and with 4MB superpages.  Each run
+// touches a region once (the page faults), then reads one word
+// per page in a scattered order, which misses the TLB on nearly
+// every access when the region is made of 4KB pages.  Heaps
+// use superpages(); shared memory segments use SHM_HUGE.  Build
+// with make NSUPERPG=4 so the 4MB runs get superpages throughout;
+// with fewer, the rest of the region falls back to 4KB pages.
+
+#define PAGE 4096
+#define SUPER (4 * 1024 * 1024)
+#define HEAPSZ (16 * 1024 * 1024)
+#define SHMSZ (4 * 1024 * 1024)
+#define ACCESSES (1 << 22)
+#define STRIDE 1021 // odd, so the walk visits every page
+
+int sum;
+
+int touch(char *mem, int size)
+{
+    int i, start;
+
+    start = uptime();
+    for (i = 0; i < size; i += PAGE)
+        mem[i] = 1;
+    return uptime() - start;
+}
+
+int walk(char *mem, int size)
+{
+    int i, p, mask, start;
+
+    mask = size / PAGE - 1;
+    p = 0;
+    start = uptime();
+    for (i = 0; i < ACCESSES; i++)
+    {
+        p = (p + STRIDE) & mask;
+        sum += mem[p * PAGE + (i & 63) * 64];
+    }
+    return uptime() - start;
+}
+
+void report(char *what, int super, int t_touch, int t_walk)
+{
+    int resident, reserved;
+
+    pagecount(&resident, &reserved);
+    printf(1, "%s %s: touch %d ticks, walk %d ticks, %d resident pages\n",
+           what, super ? "4MB" : "4KB", t_touch, t_walk, resident);
+}
+
+void heaprun(int super)
+{
+    char *mem;
+    uint cur;
+    int t;
+
+    superpages(super);
+    cur = (uint)sbrk(0);
+    if (cur % SUPER)
+        sbrk(SUPER - cur % SUPER);
+    if ((mem = sbrk(HEAPSZ)) == (char *)-1)
+    {
+        printf(1, "tlbbench: sbrk failed\n");
+        exit();
+    }
+    t = touch(mem, HEAPSZ);
+    report("heap 16MB", super, t, walk(mem, HEAPSZ));
+    exit();
+}
+
+void shmrun(int super)
+{
+    char *mem;
+    int t;
+
+    if (shm_open(super ? "tlbhuge" : "tlbsmall", SHMSZ, SHM_CREAT | (super ? SHM_HUGE : 0), &mem) < 0)
+    {
+        printf(1, "tlbbench: shm_open failed\n");
+        exit();
+    }
+    t = touch(mem, SHMSZ);
+    report("shm 4MB", super, t, walk(mem, SHMSZ));
+    exit();
+}
+
+int main(int argc, char *argv[])
+{
+    int super;
+
+    for (super = 0; super <= 1; super++)
+    {
+        if (fork() == 0)
+            heaprun(super);
+        wait();
+    }
+    for (super = 0; super <= 1; super++)
+    {
+        if (fork() == 0)
+            shmrun(super);
+        wait();
+    }
+    exit();
+}
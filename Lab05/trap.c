@@ -7,12 +7,14 @@
 #include "x86.h"
 #include "traps.h"
 #include "spinlock.h"
+#include "memstat.h"
 
 // Interrupt descriptor table (shared by all CPUs).
 struct gatedesc idt[256];
 extern uint vectors[];  // in vectors.S: array of 256 entry pointers
 struct spinlock tickslock;
 uint ticks;
+uint pgfaults[NCPU][NPF];  // lab 5: page faults by CPU and kind
 
 void
 tvinit(void)
@@ -36,6 +38,9 @@ idtinit(void)
 void
 trap(struct trapframe *tf)
 {
+  uint va;
+  int kind;
+
   if(tf->trapno == T_SYSCALL){
     if(myproc()->killed)
       exit();
@@ -78,6 +83,29 @@ trap(struct trapframe *tf)
     lapiceoi();
     break;
 
+  case T_PGFLT:
+    // lab 5: pages shared by fork are copied on the first write;
+    // program, heap, shared memory and file pages are mapped on
+    // first touch.
+    if(myproc() != 0){
+      va = rcr2();
+      if((tf->err & FEC_WR) && cowfault(myproc()->pgdir, va) == 0)
+        kind = PF_COW;
+      else if(execfault(va) == 0)
+        kind = PF_TEXT;
+      else if(heapfault(va) == 0)
+        kind = PF_HEAP;
+      else if(sharedmem_fault(va) == 0)
+        kind = PF_SHM;
+      else if(mmap_fault(va, tf->err) == 0)
+        kind = PF_MMAP;
+      else
+        kind = PF_BAD;
+      pgfaults[cpuid()][kind]++;
+      if(kind != PF_BAD)
+        break;
+    }
+    // fall through
   //PAGEBREAK: 13
   default:
     if(myproc() == 0 || (tf->cs&3) == 0){
@@ -110,3 +138,16 @@ trap(struct trapframe *tf)
   if(myproc() && myproc()->killed && (tf->cs&3) == DPL_USER)
     exit();
 }
+
+// lab 5: total page faults of each kind, for memstat.
+void
+faultstat(uint *faults)
+{
+  int i, k;
+
+  for(k = 0; k < NPF; k++){
+    faults[k] = 0;
+    for(i = 0; i < NCPU; i++)
+      faults[k] += pgfaults[i][k];
+  }
+}
@@ -0,0 +1,138 @@
+// lab 5
+// Atomic operations, spin locks and counters for user programs.
+//
+// Everything here works on plain memory, so the objects can live
+// inside a shared memory segment and be used by every process
+// that maps it, without system calls.  Include after user.h.
+
+static inline uint
+atomic_xchg(volatile uint *addr, uint newval)
+{
+  uint result;
+
+  asm volatile("lock; xchgl %0, %1" : "+m"(*addr), "=a"(result) : "1"(newval) : "memory", "cc");
+  return result;
+}
+
+// Set *addr to newval if it equals expected.
+// Returns the value *addr held before.
+static inline uint
+atomic_cmpxchg(volatile uint *addr, uint expected, uint newval)
+{
+  uint result;
+
+  asm volatile("lock; cmpxchgl %2, %1" : "=a"(result), "+m"(*addr) : "r"(newval), "0"(expected) : "memory", "cc");
+  return result;
+}
+
+// Add n to *addr; returns the value *addr held before.
+static inline int
+atomic_fetch_add(volatile int *addr, int n)
+{
+  asm volatile("lock; xaddl %0, %1" : "+r"(n), "+m"(*addr) : : "memory", "cc");
+  return n;
+}
+
+static inline void
+atomic_inc(volatile int *addr)
+{
+  asm volatile("lock; incl %0" : "+m"(*addr) : : "memory", "cc");
+}
+
+// Decrement *addr; returns 1 if it became 0.
+static inline int
+atomic_dec_and_test(volatile int *addr)
+{
+  uchar zero;
+
+  asm volatile("lock; decl %0; sete %1" : "+m"(*addr), "=q"(zero) : : "memory", "cc");
+  return zero;
+}
+
+static inline int
+atomic_load(volatile int *addr)
+{
+  int v = *addr;
+  asm volatile("" : : : "memory");
+  return v;
+}
+
+static inline void
+atomic_store(volatile int *addr, int v)
+{
+  asm volatile("" : : : "memory");
+  *addr = v;
+}
+
+// Full barrier: orders earlier stores before later loads,
+// which x86 otherwise allows to pass each other.
+static inline void
+atomic_fence(void)
+{
+  asm volatile("lock; addl $0, (%%esp)" : : : "memory", "cc");
+}
+
+static inline void
+cpu_relax(void)
+{
+  asm volatile("pause" : : : "memory");
+}
+
+// Spin lock.  A zeroed lock is unlocked.  After USPIN_MAX failed
+// tries a waiter sleeps for a tick, so a holder that was
+// preempted on the same CPU gets to run.
+#define USPIN_MAX 1000
+
+struct uspinlock
+{
+  volatile uint locked;
+};
+
+static inline int
+uspin_trylock(struct uspinlock *lk)
+{
+  return atomic_xchg(&lk->locked, 1) == 0;
+}
+
+static inline void
+uspin_lock(struct uspinlock *lk)
+{
+  int n;
+
+  for (n = 0; !uspin_trylock(lk); n++)
+  {
+    while (lk->locked)
+    {
+      if (++n >= USPIN_MAX)
+      {
+        sleep(1);
+        n = 0;
+      }
+      cpu_relax();
+    }
+  }
+}
+
+static inline void
+uspin_unlock(struct uspinlock *lk)
+{
+  atomic_xchg(&lk->locked, 0);
+}
+
+// Counter shared between processes.
+struct ucounter
+{
+  volatile int value;
+};
+
+static inline int
+ucounter_add(struct ucounter *c, int n)
+{
+  return atomic_fetch_add(&c->value, n) + n;
+}
+
+static inline int
+ucounter_read(struct ucounter *c)
+{
+  return atomic_load(&c->value);
+}
@@ -0,0 +1,241 @@
+// lab 5
+// Ring queues over shared memory; see uring.h.
+//
+// The single-producer ring keeps only head and tail: the sender
+// alone writes tail and the receiver alone writes head, so plain
+// stores ordered by the compiler are enough on x86.  The MPMC
+// ring follows Vyukov's bounded queue: each slot carries a
+// sequence number telling which lap of the ring may use it next,
+// and senders (receivers) claim slots by advancing tail (head)
+// with cmpxchg.
+
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "uatomic.h"
+#include "uring.h"
+
+#define barrier() asm volatile("" : : : "memory")
+
+static uint
+stride(struct uring *r)
+{
+  return (sizeof(struct uringslot) + r->slotsize + 3) & ~3;
+}
+
+static struct uringslot*
+slot(struct uring *r, uint pos)
+{
+  return (struct uringslot*)((char*)(r + 1) + (pos & (r->nslots - 1)) * stride(r));
+}
+
+uint
+uring_bytes(uint nslots, uint slotsize)
+{
+  return sizeof(struct uring) + nslots * ((sizeof(struct uringslot) + slotsize + 3) & ~3);
+}
+
+// Lay out a ring at r, which must have uring_bytes() of room.
+// Returns 0, or -1 if nslots is not a power of two or no
+// semaphores are left.
+int
+uring_init(struct uring *r, uint nslots, uint slotsize, int flags)
+{
+  uint i;
+
+  if(nslots == 0 || (nslots & (nslots - 1)) != 0)
+    return -1;
+  memset(r, 0, sizeof(*r));
+  r->flags = flags;
+  r->nslots = nslots;
+  r->slotsize = slotsize;
+  for(i = 0; i < nslots; i++)
+    slot(r, i)->seq = i;
+  if((r->notempty = sem_create(0)) < 0)
+    return -1;
+  if((r->notfull = sem_create(0)) < 0){
+    sync_free(r->notempty);
+    return -1;
+  }
+  return 0;
+}
+
+void
+uring_destroy(struct uring *r)
+{
+  sync_free(r->notempty);
+  sync_free(r->notfull);
+}
+
+// Claim the slot at tail for sending, or return 0 if full.
+static struct uringslot*
+claimsend(struct uring *r, uint *pos)
+{
+  struct uringslot *s;
+  uint p;
+  int d;
+
+  if(!(r->flags & URING_MPMC)){
+    p = r->tail;
+    if(p - r->head == r->nslots)
+      return 0;
+    *pos = p;
+    return slot(r, p);
+  }
+  for(p = r->tail;;){
+    s = slot(r, p);
+    d = (int)(s->seq - p);
+    if(d == 0){
+      if(atomic_cmpxchg(&r->tail, p, p + 1) == p)
+        break;
+      p = r->tail;
+    } else if(d < 0)
+      return 0;
+    else
+      p = r->tail;
+  }
+  *pos = p;
+  return s;
+}
+
+static struct uringslot*
+claimrecv(struct uring *r, uint *pos)
+{
+  struct uringslot *s;
+  uint p;
+  int d;
+
+  if(!(r->flags & URING_MPMC)){
+    p = r->head;
+    if(p == r->tail)
+      return 0;
+    barrier();
+    *pos = p;
+    return slot(r, p);
+  }
+  for(p = r->head;;){
+    s = slot(r, p);
+    d = (int)(s->seq - (p + 1));
+    if(d == 0){
+      if(atomic_cmpxchg(&r->head, p, p + 1) == p)
+        break;
+      p = r->head;
+    } else if(d < 0)
+      return 0;
+    else
+      p = r->head;
+  }
+  *pos = p;
+  return s;
+}
+
+// Post every process waiting on sem.  The fence orders the
+// store that published a slot before the load of the waiter
+// count, pairing with the fetch-add in waitfor().
+static void
+wakeall(volatile int *nwait, int sem)
+{
+  int n;
+
+  atomic_fence();
+  if(atomic_load(nwait) == 0)
+    return;
+  n = atomic_xchg((volatile uint*)nwait, 0);
+  while(n-- > 0)
+    sem_post(sem);
+}
+
+// Sleep on sem unless ready() turns true after announcing
+// ourselves.  A post meant for a waiter that did not sleep is
+// left on the semaphore and only causes a later spurious retry.
+static void
+waitfor(struct uring *r, volatile int *nwait, int sem, int (*ready)(struct uring*))
+{
+  atomic_fetch_add(nwait, 1);
+  if(ready(r))
+    return;
+  sem_wait(sem);
+}
+
+static int
+cansend(struct uring *r)
+{
+  if(!(r->flags & URING_MPMC))
+    return r->tail - r->head != r->nslots;
+  return slot(r, r->tail)->seq == r->tail;
+}
+
+static int
+canrecv(struct uring *r)
+{
+  if(!(r->flags & URING_MPMC))
+    return r->head != r->tail;
+  return slot(r, r->head)->seq == r->head + 1;
+}
+
+// Send n bytes without blocking.
+// Returns n, or -1 if the ring is full or n is too large.
+int
+uring_trysend(struct uring *r, void *buf, uint n)
+{
+  struct uringslot *s;
+  uint pos;
+
+  if(n > r->slotsize)
+    return -1;
+  if((s = claimsend(r, &pos)) == 0)
+    return -1;
+  memmove(s + 1, buf, n);
+  s->len = n;
+  barrier();
+  if(r->flags & URING_MPMC)
+    s->seq = pos + 1;
+  else
+    r->tail = pos + 1;
+  wakeall(&r->nrecvwait, r->notempty);
+  return n;
+}
+
+// Receive one message of at most max bytes without blocking.
+// Returns its length, or -1 if the ring is empty.  A longer
+// message is truncated.
+int
+uring_tryrecv(struct uring *r, void *buf, uint max)
+{
+  struct uringslot *s;
+  uint pos, n;
+
+  if((s = claimrecv(r, &pos)) == 0)
+    return -1;
+  n = s->len < max ? s->len : max;
+  memmove(buf, s + 1, n);
+  barrier();
+  if(r->flags & URING_MPMC)
+    s->seq = pos + r->nslots;
+  else
+    r->head = pos + 1;
+  wakeall(&r->nsendwait, r->notfull);
+  return n;
+}
+
+int
+uring_send(struct uring *r, void *buf, uint n)
+{
+  int k;
+
+  if(n > r->slotsize)
+    return -1;
+  while((k = uring_trysend(r, buf, n)) < 0)
+    waitfor(r, &r->nsendwait, r->notfull, cansend);
+  return k;
+}
+
+int
+uring_recv(struct uring *r, void *buf, uint max)
+{
+  int k;
+
+  while((k = uring_tryrecv(r, buf, max)) < 0)
+    waitfor(r, &r->nrecvwait, r->notempty, canrecv);
+  return k;
+}
@@ -0,0 +1,41 @@
+// lab 5
+// Ring queues of fixed-size messages in shared memory.
+//
+// A ring is laid out in place by uring_init inside a shared
+// segment, and any process that maps the segment can send or
+// receive.  Send and receive touch only the shared page while
+// the ring is neither full nor empty; a process that has to wait
+// sleeps on a kernel semaphore and is posted by the other side.
+// Include after user.h.
+
+#define URING_MPMC 0x1  // several senders and receivers
+
+struct uringslot
+{
+  volatile uint seq;  // MPMC: which lap of the ring owns the slot
+  uint len;
+};
+
+struct uring
+{
+  uint flags;
+  uint nslots;        // a power of two
+  uint slotsize;      // bytes per message, excluding the header
+  int notempty;       // semaphore handles
+  int notfull;
+  volatile int nrecvwait;
+  volatile int nsendwait;
+  char pad0[64 - 7 * sizeof(uint)];
+  volatile uint head; // next slot to receive
+  char pad1[64 - sizeof(uint)];
+  volatile uint tail; // next slot to send
+  char pad2[64 - sizeof(uint)];
+};
+
+uint uring_bytes(uint nslots, uint slotsize);
+int uring_init(struct uring *, uint nslots, uint slotsize, int flags);
+void uring_destroy(struct uring *);
+int uring_trysend(struct uring *, void *buf, uint n);
+int uring_tryrecv(struct uring *, void *buf, uint max);
+int uring_send(struct uring *, void *buf, uint n);
+int uring_recv(struct uring *, void *buf, uint max);
@@ -1,4 +1,6 @@
 struct stat;
+struct shminfo;
+struct memstat;
 struct rtcdate;
 
 // system calls
@@ -39,7 +41,24 @@ void free(void *);
 int atoi(const char *);
 
 // lab 5
-int open_sharedmem(int, char **);
+int open_sharedmem(int, int, char **);
 int close_sharedmem(int);
 int acquire_sharedmem_lock(int);
-int release_sharedmem_lock(int);
\ No newline at end of file
+int release_sharedmem_lock(int);
+int shm_open(char *, int, int, char **);
+int shm_stat(int, struct shminfo *);
+int sem_create(int value);
+int sem_wait(int sem);
+int sem_post(int sem);
+int cond_create(void);
+int cond_wait(int cond, int mutex);
+int cond_signal(int cond);
+int cond_broadcast(int cond);
+int barrier_create(int n);
+int barrier_wait(int barrier);
+int sync_free(int handle);
+void *mmap(void *, int, int, int, int, int);
+int munmap(void *, int);
+int pagecount(int *resident, int *reserved);
+int superpages(int on);
+int memstat(struct memstat *);
\ No newline at end of file
@@ -31,6 +31,7 @@ void seginit(void)
 // Return the address of the PTE in page table pgdir
 // that corresponds to virtual address va.  If alloc!=0,
 // create any required page table pages.
+// lab 5: va in a superpage has no PTE; returns 0.
 pte_t *
 walkpgdir(pde_t *pgdir, const void *va, int alloc)
 {
@@ -38,16 +39,17 @@ walkpgdir(pde_t *pgdir, const void *va, int alloc)
   pte_t *pgtab;
 
   pde = &pgdir[PDX(va)];
+  if (*pde & PTE_PS)
+    return 0;
   if (*pde & PTE_P)
   {
     pgtab = (pte_t *)P2V(PTE_ADDR(*pde));
   }
   else
   {
-    if (!alloc || (pgtab = (pte_t *)kalloc()) == 0)
-      return 0;
     // Make sure all those PTE_P bits are zero.
-    memset(pgtab, 0, PGSIZE);
+    if (!alloc || (pgtab = (pte_t *)kzalloc()) == 0)
+      return 0;
     // The permissions here are overly generous, but they can
     // be further restricted by the permissions in the page table
     // entries, if necessary.
@@ -82,6 +84,29 @@ mappages(pde_t *pgdir, void *va, uint size, uint pa, int perm)
   return 0;
 }
 
+// lab 5: map the superpage at physical address pa at va, both
+// 4MB-aligned.  An empty page table left in the way is freed.
+int mapsuper(pde_t *pgdir, uint va, uint pa, int perm)
+{
+  pde_t *pde;
+  pte_t *pgtab;
+  int i;
+
+  pde = &pgdir[PDX(va)];
+  if (*pde & PTE_P)
+  {
+    if (*pde & PTE_PS)
+      panic("remap");
+    pgtab = (pte_t *)P2V(PTE_ADDR(*pde));
+    for (i = 0; i < NPTENTRIES; i++)
+      if (pgtab[i] & PTE_P)
+        return -1;
+    kfree((char *)pgtab);
+  }
+  *pde = pa | perm | PTE_P | PTE_PS;
+  return 0;
+}
+
 // There is one page table per process, plus one that's used when
 // a CPU is not running any process (kpgdir). The kernel uses the
 // current process's page table during system calls and interrupts;
@@ -99,6 +124,11 @@ mappages(pde_t *pgdir, void *va, uint size, uint pa, int perm)
 //                                  rw data + free physical memory
 //   0xfe000000..0: mapped direct (devices such as ioapic)
 //
+// lab 5: wherever both addresses are 4MB-aligned these are
+// superpages, so most of the kernel's map needs no page tables
+// and few TLB entries; the first 4MB, holding the kernel's
+// read-only text, uses 4KB pages.
+//
 // The kernel allocates physical memory for its heap and for user memory
 // between V2P(end) and the end of physical memory (PHYSTOP)
 // (directly addressable from end..P2V(PHYSTOP)).
@@ -118,25 +148,56 @@ static struct kmap
     {(void *)DEVSPACE, DEVSPACE, 0, PTE_W},          // more devices
 };
 
+// lab 5: like mappages, but with superpages where possible.
+static int
+mapkvm(pde_t *pgdir, uint va, uint size, uint pa, int perm)
+{
+  uint n;
+
+  while (size > 0)
+  {
+    if (va % SUPERPGSIZE == 0 && pa % SUPERPGSIZE == 0 && size >= SUPERPGSIZE)
+    {
+      pgdir[PDX(va)] = pa | perm | PTE_P | PTE_PS;
+      n = SUPERPGSIZE;
+    }
+    else
+    {
+      if (mappages(pgdir, (void *)va, PGSIZE, pa, perm) < 0)
+        return -1;
+      n = PGSIZE;
+    }
+    va += n;
+    pa += n;
+    size -= n;
+  }
+  return 0;
+}
+
 // Set up kernel part of a page table.
+// lab 5: the kernel part is built once, for kpgdir; every other
+// page directory copies kpgdir's kernel entries, sharing its page
+// tables, which never change after boot.
 pde_t *
 setupkvm(void)
 {
   pde_t *pgdir;
   struct kmap *k;
 
-  if ((pgdir = (pde_t *)kalloc()) == 0)
+  if ((pgdir = (pde_t *)kzalloc()) == 0)
     return 0;
-  memset(pgdir, 0, PGSIZE);
+  if (kpgdir)
+  {
+    memmove(&pgdir[PDX(KERNBASE)], &kpgdir[PDX(KERNBASE)],
+            (NPDENTRIES - PDX(KERNBASE)) * sizeof(pde_t));
+    return pgdir;
+  }
   if (P2V(PHYSTOP) > (void *)DEVSPACE)
     panic("PHYSTOP too high");
   for (k = kmap; k < &kmap[NELEM(kmap)]; k++)
-    if (mappages(pgdir, k->virt, k->phys_end - k->phys_start,
-                 (uint)k->phys_start, k->perm) < 0)
-    {
-      freevm(pgdir);
-      return 0;
-    }
+    if (mapkvm(pgdir, (uint)k->virt, k->phys_end - k->phys_start,
+               (uint)k->phys_start, k->perm) < 0)
+      panic("setupkvm: out of memory");
   return pgdir;
 }
 
@@ -187,8 +248,7 @@ void inituvm(pde_t *pgdir, char *init, uint sz)
 
   if (sz >= PGSIZE)
     panic("inituvm: more than a page");
-  mem = kalloc();
-  memset(mem, 0, PGSIZE);
+  mem = kzalloc();
   mappages(pgdir, 0, PGSIZE, V2P(mem), PTE_W | PTE_U);
   memmove(mem, init, sz);
 }
@@ -232,14 +292,13 @@ int allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   a = PGROUNDUP(oldsz);
   for (; a < newsz; a += PGSIZE)
   {
-    mem = kalloc();
+    mem = kzalloc();
     if (mem == 0)
     {
       cprintf("allocuvm out of memory\n");
       deallocuvm(pgdir, newsz, oldsz);
       return 0;
     }
-    memset(mem, 0, PGSIZE);
     if (mappages(pgdir, (char *)a, PGSIZE, V2P(mem), PTE_W | PTE_U) < 0)
     {
       cprintf("allocuvm out of memory (2)\n");
@@ -251,14 +310,48 @@ int allocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   return newsz;
 }
 
+// lab 5: replace the superpage at base with 4KB copies of its
+// pages below end.  Returns -1, leaving it mapped, if out of memory.
+static int
+splitsuper(pde_t *pgdir, uint base, uint end)
+{
+  char *old, *mem;
+  pte_t *pgtab;
+  uint a;
+
+  old = P2V(PTE_ADDR(pgdir[PDX(base)]));
+  if ((pgtab = (pte_t *)kzalloc()) == 0)
+    return -1;
+  for (a = base; a < end; a += PGSIZE)
+  {
+    if ((mem = kalloc()) == 0)
+    {
+      while (a > base)
+      {
+        a -= PGSIZE;
+        kfree(P2V(PTE_ADDR(pgtab[PTX(a)])));
+      }
+      kfree((char *)pgtab);
+      return -1;
+    }
+    memmove(mem, old + (a - base), PGSIZE);
+    pgtab[PTX(a)] = V2P(mem) | PTE_P | PTE_W | PTE_U;
+  }
+  pgdir[PDX(base)] = V2P(pgtab) | PTE_P | PTE_W | PTE_U;
+  superfree(old);
+  return 0;
+}
+
 // Deallocate user pages to bring the process size from oldsz to
 // newsz.  oldsz and newsz need not be page-aligned, nor does newsz
 // need to be less than oldsz.  oldsz can be larger than the actual
 // process size.  Returns the new process size.
+// lab 5: a superpage left partly in use is split into 4KB pages;
+// returns 0 if there is no memory to do so.
 int deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
 {
   pte_t *pte;
-  uint a, pa;
+  uint a, pa, base;
 
   if (newsz >= oldsz)
     return oldsz;
@@ -266,6 +359,22 @@ int deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
   a = PGROUNDUP(newsz);
   for (; a < oldsz; a += PGSIZE)
   {
+    if (pgdir[PDX(a)] & PTE_PS)
+    {
+      base = a & ~(SUPERPGSIZE - 1);
+      if (base < a)
+      {
+        if (splitsuper(pgdir, base, a) < 0)
+          return 0;
+      }
+      else
+      {
+        superfree(P2V(PTE_ADDR(pgdir[PDX(a)])));
+        pgdir[PDX(a)] = 0;
+      }
+      a = base + SUPERPGSIZE - PGSIZE;
+      continue;
+    }
     pte = walkpgdir(pgdir, (char *)a, 0);
     if (!pte)
       a = PGADDR(PDX(a) + 1, 0, 0) - PGSIZE;
@@ -283,7 +392,7 @@ int deallocuvm(pde_t *pgdir, uint oldsz, uint newsz)
 }
 
 // Free a page table and all the physical memory pages
-// in the user part.
+// in the user part.  The kernel part belongs to kpgdir.
 void freevm(pde_t *pgdir)
 {
   uint i;
@@ -291,9 +400,9 @@ void freevm(pde_t *pgdir)
   if (pgdir == 0)
     panic("freevm: no pgdir");
   deallocuvm(pgdir, KERNBASE, 0);
-  for (i = 0; i < NPDENTRIES; i++)
+  for (i = 0; i < PDX(KERNBASE); i++)
   {
-    if (pgdir[i] & PTE_P)
+    if ((pgdir[i] & (PTE_P | PTE_PS)) == PTE_P)
     {
       char *v = P2V(PTE_ADDR(pgdir[i]));
       kfree(v);
@@ -314,42 +423,147 @@ void clearpteu(pde_t *pgdir, char *uva)
   *pte &= ~PTE_U;
 }
 
+// lab 5: copy the superpage at va of pgdir into d, as a
+// superpage if the pool has one left, else as 4KB pages.
+static int
+copysuper(pde_t *d, pde_t *pgdir, uint va)
+{
+  char *old, *mem;
+  uint a;
+
+  old = P2V(PTE_ADDR(pgdir[PDX(va)]));
+  if ((mem = superalloc()) != 0)
+  {
+    memmove(mem, old, SUPERPGSIZE);
+    return mapsuper(d, va, V2P(mem), PTE_W | PTE_U);
+  }
+  for (a = 0; a < SUPERPGSIZE; a += PGSIZE)
+  {
+    if ((mem = kalloc()) == 0)
+      return -1;
+    memmove(mem, old + a, PGSIZE);
+    if (mappages(d, (void *)(va + a), PGSIZE, V2P(mem), PTE_W | PTE_U) < 0)
+    {
+      kfree(mem);
+      return -1;
+    }
+  }
+  return 0;
+}
+
 // Given a parent process's page table, create a copy
-// of it for a child.
+// of it for a child.  The pages themselves are shared
+// copy-on-write.
+// lab 5: superpages are copied at once instead.
 pde_t *
 copyuvm(pde_t *pgdir, uint sz)
 {
   pde_t *d;
   pte_t *pte;
   uint pa, i, flags;
-  char *mem;
 
   if ((d = setupkvm()) == 0)
     return 0;
   for (i = 0; i < sz; i += PGSIZE)
   {
+    if (pgdir[PDX(i)] & PTE_PS)
+    {
+      if (copysuper(d, pgdir, i) < 0)
+        goto bad;
+      i += SUPERPGSIZE - PGSIZE;
+      continue;
+    }
+    // lab 5: heap pages not yet touched have no frame.
     if ((pte = walkpgdir(pgdir, (void *)i, 0)) == 0)
-      panic("copyuvm: pte should exist");
+    {
+      i = PGADDR(PDX(i) + 1, 0, 0) - PGSIZE;
+      continue;
+    }
     if (!(*pte & PTE_P))
-      panic("copyuvm: page not present");
+      continue;
+    // lab 5: share the page read-only in both page tables;
+    // the first write to it copies it (see cowfault).
+    if (*pte & PTE_W)
+      *pte = (*pte & ~PTE_W) | PTE_COW;
     pa = PTE_ADDR(*pte);
     flags = PTE_FLAGS(*pte);
-    if ((mem = kalloc()) == 0)
-      goto bad;
-    memmove(mem, (char *)P2V(pa), PGSIZE);
-    if (mappages(d, (void *)i, PGSIZE, V2P(mem), flags) < 0)
-    {
-      kfree(mem);
+    if (mappages(d, (void *)i, PGSIZE, pa, flags) < 0)
       goto bad;
-    }
+    kref(P2V(pa));
   }
+  lcr3(V2P(pgdir)); // pgdir is the caller's, and lost PTE_W
   return d;
 
 bad:
+  lcr3(V2P(pgdir));
   freevm(d);
   return 0;
 }
 
+// lab 5: number of user pages of pgdir that have a frame.
+int uvmresident(pde_t *pgdir)
+{
+  pte_t *pgtab;
+  int i, j, n;
+
+  n = 0;
+  for (i = 0; i < PDX(KERNBASE); i++)
+  {
+    if (!(pgdir[i] & PTE_P))
+      continue;
+    if (pgdir[i] & PTE_PS)
+    {
+      n += NPTENTRIES;
+      continue;
+    }
+    pgtab = (pte_t *)P2V(PTE_ADDR(pgdir[i]));
+    for (j = 0; j < NPTENTRIES; j++)
+      if (pgtab[j] & PTE_P)
+        n++;
+  }
+  return n;
+}
+
+// lab 5: number of page table pages in the user part of pgdir.
+int uvmpgtables(pde_t *pgdir)
+{
+  int i, n;
+
+  n = 0;
+  for (i = 0; i < PDX(KERNBASE); i++)
+    if ((pgdir[i] & (PTE_P | PTE_PS)) == PTE_P)
+      n++;
+  return n;
+}
+
+// lab 5: resolve a write fault at va on a copy-on-write page,
+// giving pgdir its own copy unless it holds the last reference.
+// Returns -1 if va is not a copy-on-write page or memory is
+// exhausted.
+int cowfault(pde_t *pgdir, uint va)
+{
+  pte_t *pte;
+  char *mem, *old;
+
+  if (va >= KERNBASE || (pte = walkpgdir(pgdir, (void *)va, 0)) == 0)
+    return -1;
+  if ((*pte & (PTE_P | PTE_COW)) != (PTE_P | PTE_COW))
+    return -1;
+  old = P2V(PTE_ADDR(*pte));
+  if (krefcount(old) == 1)
+    *pte = (*pte & ~PTE_COW) | PTE_W;
+  else
+  {
+    if ((mem = kalloc()) == 0)
+      return -1;
+    memmove(mem, old, PGSIZE);
+    *pte = V2P(mem) | (PTE_FLAGS(*pte) & ~PTE_COW) | PTE_W;
+    kfree(old);
+  }
+  lcr3(V2P(pgdir));
+  return 0;
+}
+
 // PAGEBREAK!
 //  Map user virtual address to kernel address.
 char *
@@ -357,8 +571,10 @@ uva2ka(pde_t *pgdir, char *uva)
 {
   pte_t *pte;
 
+  if ((pgdir[PDX(uva)] & (PTE_P | PTE_PS | PTE_U)) == (PTE_P | PTE_PS | PTE_U)) // lab 5
+    return (char *)P2V(PTE_ADDR(pgdir[PDX(uva)])) + (PGROUNDDOWN((uint)uva) & (SUPERPGSIZE - 1));
   pte = walkpgdir(pgdir, uva, 0);
-  if ((*pte & PTE_P) == 0)
+  if (pte == 0 || (*pte & PTE_P) == 0)
     return 0;
   if ((*pte & PTE_U) == 0)
     return 0;
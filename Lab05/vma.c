@@ -0,0 +1,181 @@
+// lab 5
+// Per-process virtual memory areas.
+//
+// Every region of a user address space is recorded in p->vma:
+// text and data, the stack and the heap at the bottom, laid
+// out by exec with the heap growing up from sz, and shared
+// memory segments and file mappings, placed in the highest
+// free gap below SHMTOP.
+// Freed ranges are reused, and the heap can grow until it
+// meets a mapping.  Only the owning process changes its list.
+
+#include "types.h"
+#include "defs.h"
+#include "param.h"
+#include "memlayout.h"
+#include "mmu.h"
+#include "proc.h"
+#include "mman.h"
+
+void vmainit(struct proc *p)
+{
+  memset(p->vma, 0, sizeof(p->vma));
+}
+
+// Does [start, end) overlap any area of p?
+int vmaoverlaps(struct proc *p, uint start, uint end)
+{
+  struct vma *v;
+
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+    if (v->type != VMA_FREE && start < v->end && v->start < end)
+      return 1;
+  return 0;
+}
+
+// Record area [start, end) of the given type.
+// Returns 0 if it overlaps another area or p->vma is full.
+struct vma *vmaadd(struct proc *p, int type, uint start, uint end)
+{
+  struct vma *v;
+
+  if (start > end || end > SHMTOP || vmaoverlaps(p, start, end))
+    return 0;
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+  {
+    if (v->type == VMA_FREE)
+    {
+      v->type = type;
+      v->start = start;
+      v->end = end;
+      v->shmid = -1;
+      v->file = 0;
+      v->ip = 0;
+      return v;
+    }
+  }
+  return 0;
+}
+
+// Carve size bytes (a multiple of PGSIZE) out of the highest
+// free gap below SHMTOP that lies above the heap, starting at
+// a multiple of align (a power of two, at least PGSIZE).
+struct vma *vmaplace(struct proc *p, int type, uint size, uint align)
+{
+  struct vma *v;
+  uint floor, end, start;
+
+  floor = 0;
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+    if (v->type != VMA_FREE && v->type != VMA_SHM && v->type != VMA_MMAP && v->end > floor)
+      floor = v->end;
+
+  end = SHMTOP;
+  for (;;)
+  {
+    if (size > end)
+      return 0;
+    start = (end - size) & ~(align - 1);
+    if (start < floor)
+      return 0;
+    for (v = p->vma; v < &p->vma[NVMA]; v++)
+      if (v->type != VMA_FREE && start < v->end && v->start < start + size)
+        break;
+    if (v == &p->vma[NVMA])
+      return vmaadd(p, type, start, start + size);
+    end = v->start; // try just below the area in the way
+  }
+}
+
+// Find the area of p that contains va.
+struct vma *vmafind(struct proc *p, uint va)
+{
+  struct vma *v;
+
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+    if (v->type != VMA_FREE && va >= v->start && va < v->end)
+      return v;
+  return 0;
+}
+
+// Find the first area of p of the given type.
+struct vma *vmaget(struct proc *p, int type)
+{
+  struct vma *v;
+
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+    if (v->type == type)
+      return v;
+  return 0;
+}
+
+void vmafree(struct vma *v)
+{
+  v->type = VMA_FREE;
+}
+
+// Drop the program inodes held by p's text areas
+// (exit, exec, a failed fork).
+void vmaiput(struct proc *p)
+{
+  struct vma *v;
+
+  begin_op();
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+  {
+    if (v->type == VMA_TEXT && v->ip)
+    {
+      iput(v->ip);
+      v->ip = 0;
+    }
+  }
+  end_op();
+}
+
+// Number of pages p has reserved: its areas' total size.
+int vmareserved(struct proc *p)
+{
+  struct vma *v;
+  int n;
+
+  n = 0;
+  for (v = p->vma; v < &p->vma[NVMA]; v++)
+    if (v->type != VMA_FREE)
+      n += (PGROUNDUP(v->end) - v->start) / PGSIZE;
+  return n;
+}
+
+// Check that [start, end) lies in areas of the current process,
+// and is writable if write is set, and load the file and program
+// pages it covers, so that a system call can use the range
+// without a page fault that would have to sleep.
+int vmaaccess(uint start, uint end, int write)
+{
+  struct proc *p = myproc();
+  struct vma *v;
+  pte_t *pte;
+  uint a;
+
+  if (end < start)
+    return -1;
+  for (a = PGROUNDDOWN(start); a < end; a += PGSIZE)
+  {
+    if ((v = vmafind(p, a)) == 0)
+      return -1;
+    if (v->type == VMA_TEXT && v->ip)
+    {
+      if (((pte = walkpgdir(p->pgdir, (char *)a, 0)) == 0 || !(*pte & PTE_P)) && execfault(a) < 0)
+        return -1;
+      continue;
+    }
+    if (v->type != VMA_MMAP)
+      continue;
+    if (write && !(v->prot & PROT_WRITE))
+      return -1;
+    if ((pte = walkpgdir(p->pgdir, (char *)a, 0)) != 0 && (*pte & PTE_P))
+      continue;
+    if (mmap_fault(a, write ? FEC_WR : 0) < 0)
+      return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include "types.h"
+#include "stat.h"
+#include "user.h"
+#include "memstat.h"
+
+// Print memory statistics.
+//
+//   vmstat            full report: pages, faults, caches, processes
+//   vmstat n [count]  one line every n ticks, count times (default
+//                     forever); allocations, frees and faults are
+//                     per interval
+//
+// Page counts are 4KB pages.
+
+struct memstat cur, prev;
+
+void summary(void)
+{
+    int i;
+
+    printf(1, "pages %d, free %d, zeroed %d, superpages %d/%d free\n",
+           cur.npages, cur.nfree, cur.nzero, cur.nsuperfree, cur.nsuper);
+    printf(1, "allocated %d, freed %d since boot\n", cur.nalloc, cur.nkfree);
+    printf(1, "faults: cow %d text %d heap %d shm %d mmap %d bad %d\n",
+           cur.faults[PF_COW], cur.faults[PF_TEXT], cur.faults[PF_HEAP],
+           cur.faults[PF_SHM], cur.faults[PF_MMAP], cur.faults[PF_BAD]);
+    printf(1, "shm %d segments %d pages, page cache %d pages, kernel stacks %d\n",
+           cur.nshm, cur.shmpages, cur.pcachepages, cur.kstacks);
+
+    printf(1, "\ncache\t\tsize\tslabs\tinuse\tallocs\n");
+    for (i = 0; i < cur.nslab; i++)
+        printf(1, "%s\t%d\t%d\t%d\t%d\n", cur.slab[i].name, cur.slab[i].size,
+               cur.slab[i].nslab, cur.slab[i].inuse, cur.slab[i].nalloc);
+
+    printf(1, "\npid\tname\tresident\treserved\tpgtables\n");
+    for (i = 0; i < cur.nproc; i++)
+        printf(1, "%d\t%s\t%d\t\t%d\t\t%d\n", cur.proc[i].pid, cur.proc[i].name,
+               cur.proc[i].resident, cur.proc[i].reserved, cur.proc[i].pgtables);
+}
+
+int faults(struct memstat *ms)
+{
+    int k, n;
+
+    n = 0;
+    for (k = 0; k < PF_BAD; k++)
+        n += ms->faults[k];
+    return n;
+}
+
+void line(void)
+{
+    int i, rss, pgt;
+
+    rss = pgt = 0;
+    for (i = 0; i < cur.nproc; i++)
+    {
+        rss += cur.proc[i].resident;
+        pgt += cur.proc[i].pgtables;
+    }
+    printf(1, "%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%d\n", cur.nfree, cur.nzero,
+           cur.nalloc - prev.nalloc, cur.nkfree - prev.nkfree,
+           faults(&cur) - faults(&prev), cur.faults[PF_COW] - prev.faults[PF_COW],
+           rss, pgt, cur.shmpages);
+}
+
+int main(int argc, char *argv[])
+{
+    int interval, count, i;
+
+    if (memstat(&cur) < 0)
+    {
+        printf(2, "vmstat: memstat failed\n");
+        exit();
+    }
+    if (argc < 2)
+    {
+        summary();
+        exit();
+    }
+
+    interval = atoi(argv[1]);
+    count = argc > 2 ? atoi(argv[2]) : -1;
+    if (interval <= 0)
+    {
+        printf(2, "usage: vmstat [interval [count]]\n");
+        exit();
+    }
+    printf(1, "free\tzeroed\talloc\tfree'd\tfaults\tcow\trss\tpgtabs\tshm\n");
+    for (i = 0; count < 0 || i < count; i++)
+    {
+        prev = cur;
+        sleep(interval);
+        memstat(&cur);
+        line();
+    }
+    exit();
+}
@@ -130,6 +130,14 @@ xchg(volatile uint *addr, uint newval)
   return result;
 }
 
+// Spin-wait hint: lets the other hyperthread run and avoids a
+// memory-order pipeline flush when the awaited store arrives.
+static inline void
+pause(void)
+{
+  asm volatile("pause");
+}
+
 static inline uint
 rcr2(void)
 {